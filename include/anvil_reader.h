@@ -0,0 +1,70 @@
+#ifndef ANVIL_READER_H
+#define ANVIL_READER_H
+
+#include "chunk_section.h"
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * Read-only access to a world save's Anvil region files (region/r.X.Z.mca).
+ * Region files are memory-mapped when first needed and only the requested
+ * chunks are decompressed. Block sections are decoded directly into a
+ * VoxelRegion: 1.16+ palettes are adopted as-is after mapping block names to
+ * numeric IDs, while 1.13-1.15 packed states and pre-1.13 numeric sections
+ * are unpacked block by block. Sections outside y = 0..255 are ignored.
+ */
+class AnvilWorld {
+public:
+    /**
+     * world_dir is the save folder holding "region/"; throws std::runtime_error
+     * if that directory does not exist
+     */
+    explicit AnvilWorld(const std::string& world_dir);
+    ~AnvilWorld();
+
+    AnvilWorld(const AnvilWorld&) = delete;
+    AnvilWorld& operator=(const AnvilWorld&) = delete;
+
+    /**
+     * Decode chunk (cx, cz) into out and mark all its columns loaded.
+     * A chunk that was never generated loads as air. Returns false in that
+     * case. Throws std::runtime_error for corrupt or unsupported chunk data.
+     */
+    bool loadChunk(int cx, int cz, VoxelRegion& out);
+
+    /**
+     * Load every chunk overlapping the block rectangle [min_x, max_x] x
+     * [min_z, max_z]; returns the number of chunks that held data
+     */
+    size_t loadArea(int min_x, int min_z, int max_x, int max_z, VoxelRegion& out);
+
+    size_t chunksDecoded() const { return chunks_decoded; }
+    size_t bytesInflated() const { return bytes_inflated; }
+
+    /**
+     * Legacy numeric ID for a namespaced block name such as "minecraft:oak_log".
+     * Unknown blocks map to stone so they still count as solid ground.
+     */
+    static BlockId legacyId(const std::string& name);
+
+private:
+    struct MappedFile {
+        const uint8_t* data = nullptr;
+        size_t size = 0;
+    };
+
+    std::string region_dir;
+    std::map<std::pair<int, int>, MappedFile> files;   // (rx, rz) -> mapping; empty if absent
+    std::vector<uint8_t> inflated;                      // reused decompression buffer
+    size_t chunks_decoded = 0;
+    size_t bytes_inflated = 0;
+
+    const MappedFile& regionFile(int rx, int rz);
+    bool inflateChunk(const MappedFile& file, int cx, int cz);
+};
+
+#endif // ANVIL_READER_H
@@ -0,0 +1,203 @@
+#ifndef BLOCK_WRITER_H
+#define BLOCK_WRITER_H
+
+#include "world_backend.h"
+#include <mcpp/mcpp.h>
+#include <algorithm>
+#include <bitset>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+/**
+ * Counters for the write path of one run
+ */
+struct WriteStats {
+    size_t blocks;            // blocks sent to the server
+    size_t batches;           // batches flushed
+    double mean_latency_ms;   // smoothed per-block round trip
+    int batch_size;           // current batch size
+    int pause_us;             // current pause between batches
+    double paused_ms;         // total pause between batches
+    size_t queued;            // blocks waiting for the next batch
+    size_t chunks;            // distinct chunks written
+    size_t chunk_switches;    // consecutive sent blocks in different chunks
+    size_t issued_switches;   // the same count in the order edits were issued
+    size_t superseded;        // held edits dropped because a later one replaced them
+};
+
+/**
+ * Position of chunk (cx, cz) along a Z-order (Morton) curve, so that sorting
+ * by it keeps nearby chunks close together
+ */
+inline uint64_t chunkMortonCode(int cx, int cz) {
+    uint64_t code = 0;
+    uint32_t ux = (uint32_t)cx ^ 0x80000000u;   // order negative coordinates first
+    uint32_t uz = (uint32_t)cz ^ 0x80000000u;
+    for (int bit = 0; bit < 32; bit++) {
+        code |= (uint64_t)((ux >> bit) & 1) << (2 * bit);
+        code |= (uint64_t)((uz >> bit) & 1) << (2 * bit + 1);
+    }
+    return code;
+}
+
+/**
+ * AIMD controller that holds the per-block round-trip latency near a target.
+ * The server answers no setBlock, so a batch is a run of back-to-back writes
+ * timed up to the answer to one getBlock sent after it; the server handles a
+ * connection's requests in order, so that answer only comes back once the
+ * whole batch has been applied. The only in-flight control is how long to
+ * pause between batches: above the target the batch is halved and the pause
+ * doubled, below it the batch grows and the pause decays.
+ */
+class FlowController {
+public:
+    static const int MIN_BATCH = 16;
+    static const int MAX_BATCH = 4096;
+    static const int MAX_PAUSE_US = 200000;
+
+    explicit FlowController(double target_ms)
+        : target_latency_ms(target_ms), smoothed_ms(0), batch(MIN_BATCH), pause(0) {}
+
+    double targetLatency() const { return target_latency_ms; }
+    double smoothedLatency() const { return smoothed_ms; }
+    int batchSize() const { return batch; }
+    int pauseMicros() const { return pause; }
+
+    /**
+     * Feed the measured time for a batch of blocks and adjust the limits
+     */
+    void record(double elapsed_ms, int blocks) {
+        if (blocks <= 0) {
+            return;
+        }
+        
+        // Exponentially weighted per-block round trip
+        double sample = elapsed_ms / blocks;
+        smoothed_ms = smoothed_ms == 0 ? sample : smoothed_ms * 0.8 + sample * 0.2;
+        
+        if (smoothed_ms > target_latency_ms) {
+            // Server is falling behind: back off multiplicatively
+            batch = std::max(MIN_BATCH, batch / 2);
+            pause = std::min(MAX_PAUSE_US, std::max(1000, pause * 2));
+        } else {
+            // Headroom: grow additively and let the pause decay
+            batch = std::min(MAX_BATCH, batch + MIN_BATCH);
+            pause = pause * 3 / 4;
+        }
+    }
+
+private:
+    double target_latency_ms;
+    double smoothed_ms;
+    int batch;
+    int pause;
+};
+
+/**
+ * Write path for all block edits. With no latency target, blocks are sent
+ * immediately; otherwise they are queued and sent in batches sized and
+ * paced by a FlowController. The pause after a batch delays the next batch;
+ * callers queueing edits only wait once MAX_QUEUED blocks are queued, and
+ * then send the next batch themselves when the pause ends. In chunk-ordered
+ * mode edits are instead held per chunk until flushChunks(), which sends one
+ * chunk at a time in Morton order and keeps only the last edit to each
+ * position. Safe to call from several threads; every mcpp call is made while
+ * holding the connection mutex.
+ */
+class BlockWriter {
+public:
+    static const size_t MAX_QUEUED = 2 * FlowController::MAX_BATCH;
+
+    explicit BlockWriter(std::mutex* connection_mutex = nullptr)
+        : connection(connection_mutex ? connection_mutex : &own_connection), sink(&server),
+          control(0), enabled(false), blocks(0), batches(0), paused_ms(0), chunk_ordered(false),
+          chunk_switches(0), issued_switches(0), superseded(0), has_sent(false), has_issued(false),
+          last_sent(0), last_issued(0) {}
+
+    /**
+     * Sends every edit still held or queued, so a run that stops early keeps
+     * the edits it issued
+     */
+    ~BlockWriter();
+
+    BlockWriter(const BlockWriter&) = delete;
+    BlockWriter& operator=(const BlockWriter&) = delete;
+
+    /**
+     * Hold per-block latency near target_ms; 0 disables flow control
+     */
+    void setTargetLatency(double target_ms);
+
+    /**
+     * Send edits to backend instead of the mcpp connection (null restores it)
+     */
+    void setBackend(WorldBackend* backend);
+
+    /**
+     * Hold edits per chunk until flushChunks(); turning it off sends held edits
+     */
+    void setChunkOrdering(bool enabled);
+
+    void setBlock(const mcpp::Coordinate& pos, int block_id);
+
+    /**
+     * Send queued blocks. Edits held in chunk-ordered mode wait for flushChunks().
+     */
+    void flush();
+
+    /**
+     * Send every held edit chunk by chunk in Morton order, then flush
+     */
+    void flushChunks();
+
+    WriteStats stats() const;
+
+private:
+    std::mutex own_connection;
+    std::mutex* connection;
+    McppBackend server;
+    WorldBackend* sink;
+    mutable std::mutex queue_mutex;
+    FlowController control;
+    bool enabled;
+    std::deque<std::pair<mcpp::Coordinate, int>> pending;
+    std::chrono::steady_clock::time_point resume_at;   // end of the pause after the last batch
+    size_t blocks;
+    size_t batches;
+    double paused_ms;
+
+    // Chunk-ordered mode: edits held per chunk in issue order
+    struct HeldEdit {
+        int16_t y;
+        uint8_t xz;           // (z & 15) << 4 | (x & 15)
+        int block_id;
+    };
+    bool chunk_ordered;
+    std::unordered_map<int64_t, std::vector<HeldEdit>> held;
+    std::bitset<16 * 16 * 256> seen;   // positions already kept while scanning a chunk
+
+    // Chunk locality counters
+    std::unordered_set<int64_t> touched;
+    size_t chunk_switches;
+    size_t issued_switches;
+    size_t superseded;
+    bool has_sent, has_issued;
+    int64_t last_sent, last_issued;
+
+    static int64_t chunkKey(int cx, int cz) { return ((int64_t)cx << 32) ^ (uint32_t)cz; }
+    void issue(const mcpp::Coordinate& pos, int block_id, std::unique_lock<std::mutex>& lock);
+    void send(const mcpp::Coordinate& pos, int block_id, std::unique_lock<std::mutex>& lock);
+    void noteSent(const mcpp::Coordinate& pos);
+    void sendHeld(std::unique_lock<std::mutex>& lock);
+    void drain(size_t limit, std::unique_lock<std::mutex>& lock);
+    void sendBatch();
+};
+
+#endif // BLOCK_WRITER_H
@@ -0,0 +1,128 @@
+#ifndef CHUNK_SECTION_H
+#define CHUNK_SECTION_H
+
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+typedef uint16_t BlockId;
+
+/**
+ * A 16x16x16 cube of blocks stored as a palette plus bit-packed indices.
+ * Indices use the same YZX ordering and "no spanning" long packing as
+ * Anvil sections, so a section with a single palette entry stores no data.
+ */
+class ChunkSection {
+public:
+    static const int SIZE = 16;
+    static const int VOLUME = SIZE * SIZE * SIZE;
+
+    ChunkSection() : palette(1, 0), bits(0), non_air(0) {}
+    explicit ChunkSection(BlockId fill) : palette(1, fill), bits(0), non_air(fill != 0 ? VOLUME : 0) {}
+
+    /**
+     * Adopt an already packed section (e.g. straight from an Anvil file).
+     * Returns false, leaving the section unchanged, if the sizes do not fit.
+     */
+    bool assignPacked(std::vector<BlockId>&& new_palette, std::vector<uint64_t>&& new_data, int new_bits);
+
+    BlockId get(int lx, int ly, int lz) const;
+    void set(int lx, int ly, int lz, BlockId id);
+
+    /**
+     * True if every block in the section is air
+     */
+    bool isAir() const { return non_air == 0; }
+
+    /**
+     * Highest local y holding a non-air block in column (lx, lz), or -1
+     */
+    int highestNonAir(int lx, int lz) const;
+
+    /**
+     * Write the 16 blocks of column (lx, lz) to out[0..15], bottom to top
+     */
+    void decodeColumn(int lx, int lz, BlockId* out) const;
+
+    size_t memoryUsage() const;
+
+private:
+    std::vector<BlockId> palette;
+    std::vector<uint64_t> data;
+    int bits;
+    int non_air;          // blocks that are not air; the palette never shrinks, so isAir() uses this
+
+    static int index(int lx, int ly, int lz) { return (ly << 8) | (lz << 4) | lx; }
+    int entriesPerLong() const { return 64 / bits; }
+    int readIndex(int i) const;
+    void writeIndex(int i, int value);
+    void resize(int new_bits);
+};
+
+/**
+ * Sparse block storage for an arbitrary area of the world, organised as
+ * 16x16 chunk columns of 16 sections each (y = 0..255). All-air sections
+ * are not allocated. Each block column records whether it has been loaded
+ * so callers can fill the region lazily from the server.
+ */
+class VoxelRegion {
+public:
+    static const int WORLD_HEIGHT = 256;
+    static const int SECTIONS_PER_COLUMN = WORLD_HEIGHT / ChunkSection::SIZE;
+
+    BlockId getBlock(int x, int y, int z) const;
+    void setBlock(int x, int y, int z, BlockId id);
+
+    /**
+     * Highest y holding a non-air block at (x, z), or -1 if the column is empty
+     */
+    int highestNonAir(int x, int z) const;
+
+    /**
+     * Write the full column at (x, z) to out[0..WORLD_HEIGHT-1], bottom to top
+     */
+    void decodeColumn(int x, int z, BlockId* out) const;
+
+    /**
+     * Replace the column at (x, z) with column[0..WORLD_HEIGHT-1] and mark it loaded
+     */
+    void storeColumn(int x, int z, const BlockId* column);
+
+    bool isColumnLoaded(int x, int z) const;
+    void markColumnLoaded(int x, int z);
+
+    /**
+     * Replace section sy (0..15) of chunk (cx, cz); a null or all-air section clears it
+     */
+    void storeSection(int cx, int cz, int sy, std::unique_ptr<ChunkSection> section);
+
+    /**
+     * Mark all 256 columns of chunk (cx, cz) as loaded
+     */
+    void markChunkLoaded(int cx, int cz);
+
+    size_t chunkCount() const { return chunks.size(); }
+    size_t memoryUsage() const;
+    void clear() { chunks.clear(); }
+
+private:
+    struct ChunkColumn {
+        std::unique_ptr<ChunkSection> sections[SECTIONS_PER_COLUMN];
+        std::bitset<ChunkSection::SIZE * ChunkSection::SIZE> loaded;
+    };
+
+    std::unordered_map<int64_t, std::unique_ptr<ChunkColumn>> chunks;
+
+    static int64_t chunkKey(int cx, int cz) {
+        return ((int64_t)cx << 32) ^ (uint32_t)cz;
+    }
+    static int columnIndex(int x, int z) { return ((z & 15) << 4) | (x & 15); }
+
+    const ChunkColumn* findChunk(int x, int z) const;
+    ChunkColumn& chunkAt(int x, int z);
+};
+
+#endif // CHUNK_SECTION_H
@@ -0,0 +1,82 @@
+#ifndef JOB_ARENA_H
+#define JOB_ARENA_H
+
+#include <cstddef>
+#include <memory_resource>
+
+/**
+ * Memory resource that forwards to another resource and counts the
+ * allocations passing through it
+ */
+class CountingResource : public std::pmr::memory_resource {
+public:
+    explicit CountingResource(std::pmr::memory_resource* up)
+        : upstream(up), allocations(0), bytes(0) {}
+
+    size_t allocationCount() const { return allocations; }
+    size_t bytesAllocated() const { return bytes; }
+    void resetCounts() { allocations = 0; bytes = 0; }
+
+private:
+    std::pmr::memory_resource* upstream;
+    size_t allocations;
+    size_t bytes;
+
+    void* do_allocate(size_t n, size_t align) override {
+        allocations++;
+        bytes += n;
+        return upstream->allocate(n, align);
+    }
+
+    void do_deallocate(void* p, size_t n, size_t align) override {
+        upstream->deallocate(p, n, align);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+};
+
+/**
+ * Allocation counts for the scratch arena at one point in a job
+ */
+struct ArenaStats {
+    size_t scratch_allocations;   // requests served by the arena
+    size_t heap_allocations;      // blocks the arena took from the heap
+    size_t heap_bytes;
+};
+
+/**
+ * Per-job monotonic arena for short-lived scratch buffers.
+ * Deallocation is a no-op; all memory is released together by reset(),
+ * which the generator calls at the start of each job. Not thread safe.
+ */
+class JobArena {
+public:
+    explicit JobArena(size_t initial_size = 64 * 1024)
+        : heap(std::pmr::new_delete_resource()),
+          buffer(initial_size, &heap),
+          front(&buffer) {}
+
+    JobArena(const JobArena&) = delete;
+    JobArena& operator=(const JobArena&) = delete;
+
+    std::pmr::memory_resource* resource() { return &front; }
+
+    void reset() {
+        buffer.release();
+        front.resetCounts();
+        heap.resetCounts();
+    }
+
+    ArenaStats stats() const {
+        return ArenaStats{front.allocationCount(), heap.allocationCount(), heap.bytesAllocated()};
+    }
+
+private:
+    CountingResource heap;
+    std::pmr::monotonic_buffer_resource buffer;
+    CountingResource front;
+};
+
+#endif // JOB_ARENA_H
@@ -0,0 +1,110 @@
+#ifndef NAVIGATION_H
+#define NAVIGATION_H
+
+#include <mcpp/mcpp.h>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/**
+ * Walkability and height grid over a rectangular area of the world.
+ * A step between 4-neighbours is allowed when both cells are walkable and
+ * their heights differ by at most one block; it costs 1 plus the height change.
+ */
+class WalkGrid {
+public:
+    WalkGrid(int min_x, int min_z, int width, int depth)
+        : origin_x(min_x), origin_z(min_z), w(width), d(depth),
+          heights(width * depth, 0), blocked(width * depth, 1) {}
+
+    int minX() const { return origin_x; }
+    int minZ() const { return origin_z; }
+    int width() const { return w; }
+    int depth() const { return d; }
+
+    bool inBounds(int x, int z) const {
+        return x >= origin_x && x < origin_x + w && z >= origin_z && z < origin_z + d;
+    }
+
+    void setCell(int x, int z, int height, bool walkable) {
+        int i = index(x, z);
+        heights[i] = (int16_t)height;
+        blocked[i] = walkable ? 0 : 1;
+    }
+
+    int height(int x, int z) const { return heights[index(x, z)]; }
+    bool walkable(int x, int z) const { return inBounds(x, z) && !blocked[index(x, z)]; }
+
+    bool canStep(int x0, int z0, int x1, int z1) const {
+        if (!walkable(x0, z0) || !walkable(x1, z1)) return false;
+        int dh = height(x1, z1) - height(x0, z0);
+        return dh >= -1 && dh <= 1;
+    }
+
+    int stepCost(int x0, int z0, int x1, int z1) const {
+        return height(x1, z1) != height(x0, z0) ? 2 : 1;
+    }
+
+private:
+    int origin_x, origin_z;
+    int w, d;
+    std::vector<int16_t> heights;
+    std::vector<uint8_t> blocked;
+
+    int index(int x, int z) const { return (z - origin_z) * w + (x - origin_x); }
+};
+
+/**
+ * HPA*-style pathfinder over a WalkGrid.
+ * The grid is split into square clusters; one transition node is placed in
+ * the middle of every open run along each cluster border, and nodes in the
+ * same cluster are linked by the cost of a local A* search between them.
+ * Queries search this abstract graph and then refine each hop with a local
+ * search confined to one cluster.
+ */
+class HierarchicalPathfinder {
+public:
+    explicit HierarchicalPathfinder(const WalkGrid& grid, int cluster_size = 16);
+
+    /**
+     * Find a path between two cells (x and z only). Returns every cell on
+     * the path with y set to the ground height, or an empty vector if the
+     * goal cannot be reached.
+     */
+    std::vector<mcpp::Coordinate> findPath(int from_x, int from_z, int to_x, int to_z);
+
+    size_t abstractNodeCount() const { return nodes.size(); }
+
+private:
+    struct Node {
+        int x, z;
+        int cluster;
+        std::vector<std::pair<int, int>> edges;   // (node, cost)
+    };
+
+    const WalkGrid& grid;
+    int cluster_size;
+    int clusters_x, clusters_z;
+    std::vector<Node> nodes;
+    std::unordered_map<int, int> node_at;         // grid cell -> node
+
+    // Reused buffers for local searches
+    std::vector<int> local_cost;
+    std::vector<int> local_parent;
+    std::vector<uint8_t> local_closed;
+
+    int clusterOf(int x, int z) const;
+    void clusterBounds(int cluster, int& x0, int& z0, int& x1, int& z1) const;
+    int cellKey(int x, int z) const { return (z - grid.minZ()) * grid.width() + (x - grid.minX()); }
+    int addNode(int x, int z);
+    void linkAcross(int ax, int az, int bx, int bz);
+    void connectToCluster(int node);
+    void removeTemporaryNode(int node);
+    int localSearch(int sx, int sz, int gx, int gz, int cluster,
+                    std::vector<mcpp::Coordinate>* path);
+    bool abstractSearch(int start, int goal, std::vector<int>& route);
+};
+
+#endif // NAVIGATION_H
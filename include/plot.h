@@ -2,47 +2,175 @@
 #define PLOT_H
 
 #include <mcpp/mcpp.h>
+#include <cstddef>
+#include <iterator>
 #include <vector>
 
 /**
- * Represents a single building plot in the village
+ * Represents a single building plot in the village: its x/z bounds, flat
+ * height and entrance (x, z) as plain ints. Coordinates are built on demand;
+ * origin and bound take the plot height as y and the entrance sits at y = 0.
  */
 class Plot {
 public:
-    mcpp::Coordinate origin;      // minimum/north-west (-x, -z) corner
-    mcpp::Coordinate bound;       // maximum/south-east (x, z) corner
-    mcpp::Coordinate entrance;    // entrance point for paths
-    int height;                   // flat height of the plot
+    Plot() : min_x(0), min_z(0), max_x(0), max_z(0), plot_height(0), entrance_x(0), entrance_z(0) {}
     
-    Plot() : height(0) {}
+    Plot(int x0, int z0, int x1, int z1, int h, int ex = 0, int ez = 0)
+        : min_x(x0), min_z(z0), max_x(x1), max_z(z1), plot_height(h), entrance_x(ex), entrance_z(ez) {}
     
-    Plot(mcpp::Coordinate o, mcpp::Coordinate b, mcpp::Coordinate e, int h)
-        : origin(o), bound(b), entrance(e), height(h) {}
+    int minX() const { return min_x; }   // minimum/north-west (-x, -z) corner
+    int minZ() const { return min_z; }
+    int maxX() const { return max_x; }   // maximum/south-east (x, z) corner
+    int maxZ() const { return max_z; }
+    int height() const { return plot_height; }
+    
+    mcpp::Coordinate origin() const { return mcpp::Coordinate(min_x, plot_height, min_z); }
+    mcpp::Coordinate bound() const { return mcpp::Coordinate(max_x, plot_height, max_z); }
+    mcpp::Coordinate entrance() const { return mcpp::Coordinate(entrance_x, 0, entrance_z); }
+    
+    /**
+     * Set the entrance point for paths; only its x and z are kept
+     */
+    void setEntrance(const mcpp::Coordinate& e) {
+        entrance_x = e.x;
+        entrance_z = e.z;
+    }
     
     /**
      * Get the center of the plot
      */
     mcpp::Coordinate getCenter() const {
-        return mcpp::Coordinate(
-            (origin.x + bound.x) / 2,
-            (origin.y + bound.y) / 2,
-            (origin.z + bound.z) / 2
-        );
+        return mcpp::Coordinate((min_x + max_x) / 2, plot_height, (min_z + max_z) / 2);
     }
     
     /**
      * Get the width of the plot (x-axis)
      */
     int getWidth() const {
-        return bound.x - origin.x + 1;
+        return max_x - min_x + 1;
     }
     
     /**
      * Get the depth of the plot (z-axis)
      */
     int getDepth() const {
-        return bound.z - origin.z + 1;
+        return max_z - min_z + 1;
     }
+
+private:
+    int min_x, min_z;
+    int max_x, max_z;
+    int plot_height;
+    int entrance_x, entrance_z;
+};
+
+/**
+ * Compact structure-of-arrays storage for a list of plots.
+ * Each plot is stored as its x/z bounds, height and entrance (x, z) in
+ * parallel int arrays; indexing copies those seven ints into a Plot.
+ */
+class PlotSet {
+public:
+    /**
+     * Proxy iterator: dereferencing copies a Plot out by value, so it is only
+     * an input iterator
+     */
+    class const_iterator {
+    public:
+        class arrow_proxy {
+        public:
+            explicit arrow_proxy(const Plot& p) : plot(p) {}
+            const Plot* operator->() const { return &plot; }
+        private:
+            Plot plot;
+        };
+
+        typedef std::input_iterator_tag iterator_category;
+        typedef Plot value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef arrow_proxy pointer;
+        typedef Plot reference;
+
+        const_iterator(const PlotSet* s, size_t i) : set(s), index(i) {}
+        Plot operator*() const { return (*set)[index]; }
+        arrow_proxy operator->() const { return arrow_proxy((*set)[index]); }
+        const_iterator& operator++() { ++index; return *this; }
+        const_iterator operator++(int) { const_iterator old = *this; ++index; return old; }
+        bool operator==(const const_iterator& other) const { return index == other.index; }
+        bool operator!=(const const_iterator& other) const { return index != other.index; }
+
+    private:
+        const PlotSet* set;
+        size_t index;
+    };
+
+    size_t size() const { return min_x.size(); }
+    bool empty() const { return min_x.empty(); }
+
+    void reserve(size_t n) {
+        min_x.reserve(n); min_z.reserve(n);
+        max_x.reserve(n); max_z.reserve(n);
+        heights.reserve(n);
+        entrance_x.reserve(n); entrance_z.reserve(n);
+    }
+
+    void push_back(const Plot& plot) {
+        mcpp::Coordinate entrance = plot.entrance();
+        min_x.push_back(plot.minX());
+        min_z.push_back(plot.minZ());
+        max_x.push_back(plot.maxX());
+        max_z.push_back(plot.maxZ());
+        heights.push_back(plot.height());
+        entrance_x.push_back(entrance.x);
+        entrance_z.push_back(entrance.z);
+    }
+
+    Plot operator[](size_t i) const {
+        return Plot(min_x[i], min_z[i], max_x[i], max_z[i], heights[i], entrance_x[i], entrance_z[i]);
+    }
+
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, size()); }
+
+    int minX(size_t i) const { return min_x[i]; }
+    int minZ(size_t i) const { return min_z[i]; }
+    int maxX(size_t i) const { return max_x[i]; }
+    int maxZ(size_t i) const { return max_z[i]; }
+    int height(size_t i) const { return heights[i]; }
+    int centerX(size_t i) const { return (min_x[i] + max_x[i]) / 2; }
+    int centerZ(size_t i) const { return (min_z[i] + max_z[i]) / 2; }
+    mcpp::Coordinate entrance(size_t i) const {
+        return mcpp::Coordinate(entrance_x[i], 0, entrance_z[i]);
+    }
+
+    /**
+     * True if the box [x0, x1] x [z0, z1] overlaps any stored plot.
+     * The loop has no early exit so the compiler can vectorise it.
+     */
+    bool intersectsAny(int x0, int z0, int x1, int z1) const {
+        const int* ax = min_x.data();
+        const int* az = min_z.data();
+        const int* bx = max_x.data();
+        const int* bz = max_z.data();
+        int hit = 0;
+        for (size_t i = 0, n = size(); i < n; i++) {
+            hit |= (x1 >= ax[i]) & (x0 <= bx[i]) & (z1 >= az[i]) & (z0 <= bz[i]);
+        }
+        return hit != 0;
+    }
+
+    /**
+     * True if (x, z) lies inside any stored plot
+     */
+    bool containsAny(int x, int z) const {
+        return intersectsAny(x, z, x, z);
+    }
+
+private:
+    std::vector<int> min_x, min_z;
+    std::vector<int> max_x, max_z;
+    std::vector<int> heights;
+    std::vector<int> entrance_x, entrance_z;
 };
 
 #endif // PLOT_H
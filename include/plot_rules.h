@@ -0,0 +1,193 @@
+#ifndef PLOT_RULES_H
+#define PLOT_RULES_H
+
+#include "chunk_section.h"
+#include <array>
+#include <cstdint>
+#include <initializer_list>
+#include <string>
+#include <tuple>
+
+/**
+ * Block classes used by plot rules, as bit flags
+ */
+enum BlockClass : uint8_t {
+    BLOCK_CLASS_NONE  = 0,
+    BLOCK_CLASS_WATER = 1 << 0,
+    BLOCK_CLASS_TREE  = 1 << 1,
+};
+
+/**
+ * Compile-time lookup from block ID to BlockClass flags
+ */
+struct BlockClassTable {
+    std::array<uint8_t, 256> flags;
+
+    constexpr uint8_t lookup(BlockId id) const {
+        return id < flags.size() ? flags[id] : (uint8_t)BLOCK_CLASS_NONE;
+    }
+
+    constexpr BlockClassTable with(std::initializer_list<BlockId> ids, BlockClass cls) const {
+        BlockClassTable table = *this;
+        for (BlockId id : ids) {
+            table.flags[id] |= cls;
+        }
+        return table;
+    }
+};
+
+constexpr BlockClassTable EMPTY_BLOCK_CLASSES = BlockClassTable{{}};
+
+// Water: 8/9 (flowing/stationary). Trees: 17 (wood), 18 (leaves).
+constexpr BlockClassTable DEFAULT_BLOCK_CLASSES =
+    EMPTY_BLOCK_CLASSES.with({8, 9}, BLOCK_CLASS_WATER).with({17, 18}, BLOCK_CLASS_TREE);
+
+// Ice (79) and packed ice (174) cover frozen water
+constexpr BlockClassTable SNOWY_BLOCK_CLASSES =
+    DEFAULT_BLOCK_CLASSES.with({79, 174}, BLOCK_CLASS_WATER);
+
+// Cactus (81) and dead bushes (32) stand above the ground like trees
+constexpr BlockClassTable DESERT_BLOCK_CLASSES =
+    DEFAULT_BLOCK_CLASSES.with({81, 32}, BLOCK_CLASS_TREE);
+
+// Acacia/dark oak wood (162), their leaves (161) and vines (106)
+constexpr BlockClassTable JUNGLE_BLOCK_CLASSES =
+    DEFAULT_BLOCK_CLASSES.with({161, 162, 106}, BLOCK_CLASS_TREE);
+
+static_assert(DEFAULT_BLOCK_CLASSES.lookup(9) == BLOCK_CLASS_WATER, "water class");
+static_assert(DEFAULT_BLOCK_CLASSES.lookup(18) == BLOCK_CLASS_TREE, "tree class");
+
+/**
+ * Thresholds and block classes for plot validation
+ */
+struct PlotRuleConfig {
+    double max_water_fraction = 0.15;
+    int max_slope = 15;
+    const BlockClassTable* classes = &DEFAULT_BLOCK_CLASSES;
+};
+
+/**
+ * Rule configuration for a named biome; returns false for an unknown name
+ */
+inline bool plotRulesForBiome(const std::string& biome, PlotRuleConfig& config) {
+    config = PlotRuleConfig();
+    if (biome == "default" || biome == "plains" || biome == "forest") {
+        return true;
+    } else if (biome == "swamp") {
+        config.max_water_fraction = 0.30;
+    } else if (biome == "mountains") {
+        config.max_slope = 25;
+    } else if (biome == "snowy") {
+        config.classes = &SNOWY_BLOCK_CLASSES;
+    } else if (biome == "desert") {
+        config.max_water_fraction = 0.05;
+        config.classes = &DESERT_BLOCK_CLASSES;
+    } else if (biome == "jungle") {
+        config.max_slope = 20;
+        config.classes = &JUNGLE_BLOCK_CLASSES;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Surface cell seen by the rules: ground height, top block and its classes
+ */
+struct SurfaceCell {
+    int height;
+    BlockId block;
+    uint8_t classes;
+};
+
+/**
+ * Fails once more than the fraction config.*MaxFraction of the footprint is of
+ * class Cls
+ */
+template <uint8_t Cls, double PlotRuleConfig::*MaxFraction>
+struct MaxCoverageRule {
+    double max_fraction;
+    int total;
+    int count;
+
+    void begin(const PlotRuleConfig& config, int cells) {
+        max_fraction = config.*MaxFraction;
+        total = cells;
+        count = 0;
+    }
+
+    bool accept(const SurfaceCell& cell) {
+        if (cell.classes & Cls) {
+            count++;
+            // The count only grows, so once over the limit the rule cannot pass
+            return (double)count / total <= max_fraction;
+        }
+        return true;
+    }
+};
+
+/**
+ * Fails once the height range of cells not of class Ignored exceeds max_slope
+ */
+template <uint8_t Ignored>
+struct MaxSlopeRule {
+    int max_slope;
+    int min_height;
+    int max_height;
+
+    void begin(const PlotRuleConfig& config, int) {
+        max_slope = config.max_slope;
+        min_height = 255;
+        max_height = 0;
+    }
+
+    bool accept(const SurfaceCell& cell) {
+        if (cell.classes & Ignored) {
+            return true;
+        }
+        min_height = cell.height < min_height ? cell.height : min_height;
+        max_height = cell.height > max_height ? cell.height : max_height;
+        // The range only widens, so once too steep the rule cannot pass
+        return max_height - min_height <= max_slope;
+    }
+};
+
+/**
+ * Evaluates all Rules in a single pass over a footprint, stopping at the
+ * first cell after which any rule can no longer be met
+ */
+template <typename... Rules>
+class PlotRuleEngine {
+public:
+    /**
+     * cell_at(x, z) must return the SurfaceCell at that column
+     */
+    template <typename CellSource>
+    bool evaluate(const PlotRuleConfig& config, int min_x, int min_z, int max_x, int max_z,
+                  CellSource&& cell_at) {
+        int cells = (max_x - min_x + 1) * (max_z - min_z + 1);
+        std::apply([&](Rules&... rule) { (rule.begin(config, cells), ...); }, rules);
+
+        for (int x = min_x; x <= max_x; x++) {
+            for (int z = min_z; z <= max_z; z++) {
+                SurfaceCell cell = cell_at(x, z);
+                bool ok = std::apply([&](Rules&... rule) { return (rule.accept(cell) && ...); }, rules);
+                if (!ok) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+private:
+    std::tuple<Rules...> rules;
+};
+
+/**
+ * Water coverage and slope (ignoring trees), the rules every plot must meet
+ */
+typedef PlotRuleEngine<MaxCoverageRule<BLOCK_CLASS_WATER, &PlotRuleConfig::max_water_fraction>,
+                       MaxSlopeRule<BLOCK_CLASS_TREE>> DefaultPlotRules;
+
+#endif // PLOT_RULES_H
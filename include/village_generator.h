@@ -2,10 +2,58 @@
 #define VILLAGE_GENERATOR_H
 
 #include "plot.h"
+#include "anvil_reader.h"
+#include "chunk_section.h"
+#include "job_arena.h"
+#include "navigation.h"
+#include "block_writer.h"
+#include "world_backend.h"
+#include "plot_rules.h"
 #include <mcpp/mcpp.h>
+#include <algorithm>
+#include <functional>
+#include <mutex>
 #include <vector>
 #include <random>
 
+/**
+ * Wall-clock milliseconds from the start of a pipelined run until each stage finished
+ */
+struct PipelineTimings {
+    double search_ms;
+    double terraform_ms;
+    double wall_ms;
+    double waypoints_ms;
+};
+
+/**
+ * Test-mode grid points and the terrain-rule results speculated for them so far.
+ * fits holds one byte per point (row-major, z then x) with bit (size - min_size) set
+ * when a plot of that size centred there passes; only rows below speculated_rows are
+ * filled. surface holds the columns under every footprint of those rows, starting at
+ * (first_x - max_size / 2, first_z - max_size / 2); only rows below surface_rows are read.
+ */
+struct GridSpeculation {
+    int first_x, first_z, step, min_size, max_size;
+    int columns, rows;
+    int speculated_rows;
+    int surface_width, surface_rows;
+    std::vector<SurfaceCell> surface;
+    std::vector<uint8_t> fits;
+    
+    GridSpeculation(int fx, int fz, int last_x, int last_z, int st, int min_s, int max_s)
+        : first_x(fx), first_z(fz), step(st), min_size(min_s), max_size(max_s),
+          columns(last_x >= fx && last_z >= fz ? (last_x - fx) / st + 1 : 0),
+          rows(last_x >= fx && last_z >= fz ? (last_z - fz) / st + 1 : 0),
+          speculated_rows(0), surface_width(columns ? (columns - 1) * st + max_s : 0), surface_rows(0),
+          surface((size_t)surface_width * (rows ? (rows - 1) * st + max_s : 0)),
+          fits((size_t)columns * rows, 0) {}
+    
+    bool fitsAt(int row, int column, int size) const {
+        return (fits[(size_t)row * columns + column] >> (size - min_size)) & 1;
+    }
+};
+
 /**
  * Main village generator class handling all Part A tasks
  */
@@ -17,39 +65,145 @@ private:
     int seed;
     bool test_mode;
     std::mt19937 rng;
+    VoxelRegion terrain;          // unedited copy of every column read
+    VoxelRegion edits;            // columns as they stand after our own edits
+    std::mutex terrain_mutex;
+    std::mutex edits_mutex;
+    std::mutex io_mutex;          // serialises every mcpp call
+    JobArena arena;               // scratch buffers, released at the start of each job
+    BlockWriter writer;           // flow-controlled write path to the server
+    AnvilWorld* world_source;     // region files to read terrain from, or null for the server
+    McppBackend server;
+    WorldBackend* backend;        // where terrain is read from and edits are sent
+    int next_plot_size;           // test mode: size of the next plot the grid scan accepts
+    unsigned scan_threads;        // test mode: threads evaluating grid points (0 = one per core)
+    PlotRuleConfig rule_config;   // thresholds and block classes for plot validation
+    DefaultPlotRules plot_rules;
     
+    void loadColumn(int x, int z);
+    int terrainHeight(int x, int z);
+    BlockId terrainBlock(int x, int y, int z);
     mcpp::Coordinate getHighestBlock(int x, int z);
-    bool isValidPlot(const Plot& plot, const std::vector<Plot>& existing_plots);
-    bool checkWaterCoverage(const Plot& plot);
-    bool checkSlopeDelta(const Plot& plot);
-    bool checkBorderIntersection(const Plot& plot, const std::vector<Plot>& existing_plots);
-    bool checkPlotIntersection(const Plot& plot, const std::vector<Plot>& existing_plots);
+    int worldHeight(int x, int z);
+    int borderHeight(int x, int z);
+    BlockId worldBlock(int x, int y, int z);
+    void placeBlock(const mcpp::Coordinate& pos, int block_id);
+    PlotSet findPlots(const std::function<void(const Plot&)>& on_accept);
+    void terraformPlot(const Plot& plot);
+    bool isValidPlot(const Plot& plot, const PlotSet& existing_plots);
+    bool checkTerrainRules(const Plot& plot);
+    bool checkBorderIntersection(const Plot& plot, const PlotSet& existing_plots);
+    bool checkPlotIntersection(const Plot& plot, const PlotSet& existing_plots);
+    bool checkVillageBounds(const Plot& plot);
+    bool speculateGridRows(GridSpeculation& grid, int row);
     mcpp::Coordinate selectEntrance(const Plot& plot);
+    int minPlotCount() const { return std::max(1, village_size / 50); }
+    WalkGrid buildWalkGrid(const PlotSet& plots);
     
 public:
     VillageGenerator(mcpp::Coordinate center, int size, int border, int s, bool test)
         : village_center(center), village_size(size), plot_border(border), 
-          seed(s), test_mode(test), rng(s) {}
+          seed(s), test_mode(test), rng(s), writer(&io_mutex), world_source(nullptr),
+          backend(&server), next_plot_size(14), scan_threads(0) {}
     
     /**
      * Find all valid plots in the village area
      */
-    std::vector<Plot> findPlots();
+    PlotSet findPlots();
     
     /**
      * Terraform the land around plots
      */
-    void terraformPlots(const std::vector<Plot>& plots);
+    void terraformPlots(const PlotSet& plots);
     
     /**
      * Build the village wall
      */
-    void buildWall(const std::vector<Plot>& plots);
+    void buildWall(const PlotSet& plots);
     
     /**
      * Place waypoints for pathfinding
      */
-    std::vector<mcpp::Coordinate> placeWaypoints(const std::vector<Plot>& plots);
+    std::vector<mcpp::Coordinate> placeWaypoints(const PlotSet& plots);
+    
+    /**
+     * Find a path from every plot entrance to its nearest waypoint and lay
+     * the path blocks. Returns one path per plot (empty if unreachable).
+     */
+    std::vector<std::vector<mcpp::Coordinate>> placePaths(const PlotSet& plots,
+                                                          const std::vector<mcpp::Coordinate>& waypoints);
+    
+    /**
+     * Run plot finding, terraforming, wall building and waypoint placement
+     * with overlapping stages. Produces the same plots, waypoints and world
+     * as calling the four stages in order.
+     */
+    PipelineTimings runPipelined(PlotSet& plots, std::vector<mcpp::Coordinate>& waypoints);
+    
+    /**
+     * Read and write blocks through backend instead of the mcpp connection
+     * (null restores it). backend must outlive the generator.
+     */
+    void setWorldBackend(WorldBackend* world) {
+        backend = world ? world : &server;
+        writer.setBackend(world);
+    }
+    
+    /**
+     * Read terrain from local region files instead of the server. Writes
+     * still go to the server. world must outlive the generator.
+     */
+    void setWorldSource(AnvilWorld* world) { world_source = world; }
+    
+    /**
+     * Decode every chunk covering the village and its plot_border halo from
+     * the world source up front; returns the number of chunks that held data
+     */
+    size_t preloadTerrain();
+    
+    /**
+     * Unedited terrain read by plot finding
+     */
+    const VoxelRegion& getTerrain() const { return terrain; }
+    
+    /**
+     * Columns changed by terraforming, walls and paths, as they now stand
+     */
+    const VoxelRegion& getEdits() const { return edits; }
+    
+    /**
+     * Allocation counts for the scratch arena since the current job started
+     */
+    ArenaStats getArenaStats() const { return arena.stats(); }
+    
+    /**
+     * Pace writes to hold per-block server latency near target_ms (0 = unpaced)
+     */
+    void setTargetLatency(double target_ms) { writer.setTargetLatency(target_ms); }
+    
+    /**
+     * Hold all edits until commitWrites() and then send them chunk by chunk
+     */
+    void setChunkOrderedWrites(bool enabled) { writer.setChunkOrdering(enabled); }
+    
+    /**
+     * Send every edit still held by the chunk-ordered write scheduler. Edits
+     * still held when the generator is destroyed are sent then, so a run that
+     * fails part way keeps the edits its earlier stages issued.
+     */
+    void commitWrites() { writer.flushChunks(); }
+    
+    WriteStats getWriteStats() const { return writer.stats(); }
+    
+    /**
+     * Threads for the test-mode grid scan's terrain checks (0 = one per core)
+     */
+    void setScanThreads(unsigned threads) { scan_threads = threads; }
+    
+    /**
+     * Replace the plot validation thresholds and block classes
+     */
+    void setRuleConfig(const PlotRuleConfig& config) { rule_config = config; }
 };
 
 #endif // VILLAGE_GENERATOR_H
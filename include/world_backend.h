@@ -0,0 +1,32 @@
+#ifndef WORLD_BACKEND_H
+#define WORLD_BACKEND_H
+
+#include "chunk_section.h"
+#include <mcpp/mcpp.h>
+
+/**
+ * Where the generator reads blocks from and sends edits to. Calls are
+ * serialised by the caller, so implementations need not be thread safe.
+ */
+class WorldBackend {
+public:
+    virtual ~WorldBackend() {}
+    virtual BlockId getBlock(int x, int y, int z) = 0;
+    virtual void setBlock(int x, int y, int z, BlockId id) = 0;
+};
+
+/**
+ * The live Minecraft server, through the mcpp connection
+ */
+class McppBackend : public WorldBackend {
+public:
+    BlockId getBlock(int x, int y, int z) override {
+        return (BlockId)mcpp::getBlock(mcpp::Coordinate(x, y, z)).id;
+    }
+
+    void setBlock(int x, int y, int z, BlockId id) override {
+        mcpp::setBlock(mcpp::Coordinate(x, y, z), mcpp::Block(id));
+    }
+};
+
+#endif // WORLD_BACKEND_H
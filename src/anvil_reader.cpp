@@ -0,0 +1,502 @@
+#include "anvil_reader.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <zlib.h>
+#include <climits>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace {
+
+// NBT tag types
+enum : uint8_t {
+    TAG_END = 0, TAG_BYTE, TAG_SHORT, TAG_INT, TAG_LONG, TAG_FLOAT, TAG_DOUBLE,
+    TAG_BYTE_ARRAY, TAG_STRING, TAG_LIST, TAG_COMPOUND, TAG_INT_ARRAY, TAG_LONG_ARRAY
+};
+
+const int SECTOR_BYTES = 4096;
+const int MAX_NBT_DEPTH = 512;
+
+// First data version (20w17a, 1.16) whose packed block states never span two longs
+const int NO_SPAN_DATA_VERSION = 2529;
+
+/**
+ * Bounds-checked big-endian reader over an uncompressed NBT buffer
+ */
+class NbtReader {
+public:
+    NbtReader(const uint8_t* data, size_t size) : pos(data), end(data + size) {}
+
+    const uint8_t* take(size_t n) {
+        if ((size_t)(end - pos) < n) {
+            throw std::runtime_error("Truncated chunk NBT data");
+        }
+        const uint8_t* p = pos;
+        pos += n;
+        return p;
+    }
+
+    uint8_t byte() { return *take(1); }
+
+    int32_t int32() {
+        const uint8_t* p = take(4);
+        return (int32_t)((uint32_t)p[0] << 24 | (uint32_t)p[1] << 16 | (uint32_t)p[2] << 8 | p[3]);
+    }
+
+    std::string string() {
+        const uint8_t* p = take(2);
+        size_t length = (size_t)p[0] << 8 | p[1];
+        return std::string((const char*)take(length), length);
+    }
+
+    void skipString() {
+        const uint8_t* p = take(2);
+        take((size_t)p[0] << 8 | p[1]);
+    }
+
+    /**
+     * Array length prefix, rejecting negative values
+     */
+    size_t length() {
+        int32_t n = int32();
+        if (n < 0) {
+            throw std::runtime_error("Negative NBT array length");
+        }
+        return (size_t)n;
+    }
+
+    void skip(uint8_t type, int depth = 0) {
+        if (depth > MAX_NBT_DEPTH) {
+            throw std::runtime_error("NBT data nested too deeply");
+        }
+        switch (type) {
+            case TAG_BYTE: take(1); break;
+            case TAG_SHORT: take(2); break;
+            case TAG_INT: case TAG_FLOAT: take(4); break;
+            case TAG_LONG: case TAG_DOUBLE: take(8); break;
+            case TAG_BYTE_ARRAY: take(length()); break;
+            case TAG_STRING: skipString(); break;
+            case TAG_INT_ARRAY: take(length() * 4); break;
+            case TAG_LONG_ARRAY: take(length() * 8); break;
+            case TAG_LIST: {
+                uint8_t element = byte();
+                size_t count = length();
+                for (size_t i = 0; i < count; i++) {
+                    skip(element, depth + 1);
+                }
+                break;
+            }
+            case TAG_COMPOUND: {
+                uint8_t child;
+                while ((child = byte()) != TAG_END) {
+                    skipString();
+                    skip(child, depth + 1);
+                }
+                break;
+            }
+            default:
+                throw std::runtime_error("Unknown NBT tag type " + std::to_string(type));
+        }
+    }
+
+private:
+    const uint8_t* pos;
+    const uint8_t* end;
+};
+
+/**
+ * Block data found in one section compound; arrays point into the NBT buffer
+ */
+struct SectionData {
+    int y = INT_MIN;
+    std::vector<BlockId> palette;
+    const uint8_t* states = nullptr;   // big-endian longs
+    size_t state_count = 0;
+    const uint8_t* blocks = nullptr;   // pre-1.13: 4096 low ID bytes
+    const uint8_t* add = nullptr;      // pre-1.13: 2048 bytes of high ID nibbles
+};
+
+struct ChunkData {
+    int data_version = 0;
+    std::vector<SectionData> sections;
+};
+
+std::vector<uint64_t> readLongs(const uint8_t* p, size_t count) {
+    std::vector<uint64_t> longs(count);
+    for (size_t i = 0; i < count; i++, p += 8) {
+        uint64_t v = 0;
+        for (int b = 0; b < 8; b++) {
+            v = v << 8 | p[b];
+        }
+        longs[i] = v;
+    }
+    return longs;
+}
+
+void readPalette(NbtReader& in, std::vector<BlockId>& palette) {
+    uint8_t element = in.byte();
+    size_t count = in.length();
+    if (element != TAG_COMPOUND) {
+        for (size_t i = 0; i < count; i++) in.skip(element);
+        return;
+    }
+    palette.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        std::string block_name;
+        uint8_t type;
+        while ((type = in.byte()) != TAG_END) {
+            std::string name = in.string();
+            if (type == TAG_STRING && name == "Name") {
+                block_name = in.string();
+            } else {
+                in.skip(type);
+            }
+        }
+        palette.push_back(AnvilWorld::legacyId(block_name));
+    }
+}
+
+void readLongArray(NbtReader& in, SectionData& section) {
+    section.state_count = in.length();
+    section.states = in.take(section.state_count * 8);
+}
+
+/**
+ * 1.18+ "block_states" compound: { palette: [...], data: [L; ...] }
+ */
+void readBlockStates(NbtReader& in, SectionData& section) {
+    uint8_t type;
+    while ((type = in.byte()) != TAG_END) {
+        std::string name = in.string();
+        if (type == TAG_LIST && name == "palette") {
+            readPalette(in, section.palette);
+        } else if (type == TAG_LONG_ARRAY && name == "data") {
+            readLongArray(in, section);
+        } else {
+            in.skip(type);
+        }
+    }
+}
+
+void readSection(NbtReader& in, SectionData& section) {
+    uint8_t type;
+    while ((type = in.byte()) != TAG_END) {
+        std::string name = in.string();
+        if (name == "Y" && type == TAG_BYTE) {
+            section.y = (int8_t)in.byte();
+        } else if (name == "Y" && type == TAG_INT) {
+            section.y = in.int32();
+        } else if (type == TAG_LIST && name == "Palette") {
+            readPalette(in, section.palette);
+        } else if (type == TAG_LONG_ARRAY && name == "BlockStates") {
+            readLongArray(in, section);
+        } else if (type == TAG_COMPOUND && name == "block_states") {
+            readBlockStates(in, section);
+        } else if (type == TAG_BYTE_ARRAY && name == "Blocks") {
+            if (in.length() != (size_t)ChunkSection::VOLUME) {
+                throw std::runtime_error("Malformed legacy Blocks array");
+            }
+            section.blocks = in.take(ChunkSection::VOLUME);
+        } else if (type == TAG_BYTE_ARRAY && name == "Add") {
+            if (in.length() != (size_t)ChunkSection::VOLUME / 2) {
+                throw std::runtime_error("Malformed legacy Add array");
+            }
+            section.add = in.take(ChunkSection::VOLUME / 2);
+        } else {
+            in.skip(type);
+        }
+    }
+}
+
+/**
+ * Walk the chunk compound, descending into "Level" for pre-1.18 chunks
+ */
+void readChunk(NbtReader& in, ChunkData& chunk, int depth) {
+    uint8_t type;
+    while ((type = in.byte()) != TAG_END) {
+        std::string name = in.string();
+        if (type == TAG_INT && name == "DataVersion") {
+            chunk.data_version = in.int32();
+        } else if (type == TAG_COMPOUND && name == "Level" && depth == 0) {
+            readChunk(in, chunk, depth + 1);
+        } else if (type == TAG_LIST && (name == "Sections" || name == "sections")) {
+            uint8_t element = in.byte();
+            size_t count = in.length();
+            for (size_t i = 0; i < count; i++) {
+                if (element == TAG_COMPOUND) {
+                    chunk.sections.emplace_back();
+                    readSection(in, chunk.sections.back());
+                } else {
+                    in.skip(element);
+                }
+            }
+        } else {
+            in.skip(type);
+        }
+    }
+}
+
+/**
+ * Build a ChunkSection from decoded section data, or null if it holds no blocks
+ */
+std::unique_ptr<ChunkSection> buildSection(const SectionData& data, int data_version) {
+    std::unique_ptr<ChunkSection> section;
+
+    if (!data.palette.empty()) {
+        if (data.palette.size() == 1) {
+            return std::make_unique<ChunkSection>(data.palette[0]);
+        }
+        if (!data.states) {
+            throw std::runtime_error("Section palette without block states");
+        }
+        int bits = 4;
+        while (((size_t)1 << bits) < data.palette.size()) bits++;
+        std::vector<uint64_t> longs = readLongs(data.states, data.state_count);
+
+        section = std::make_unique<ChunkSection>();
+        if (data_version >= NO_SPAN_DATA_VERSION) {
+            // Same packing as ChunkSection, so the palette is adopted unchanged
+            std::vector<BlockId> palette = data.palette;
+            if (!section->assignPacked(std::move(palette), std::move(longs), bits)) {
+                throw std::runtime_error("Malformed section block states");
+            }
+            return section;
+        }
+
+        // 1.13-1.15: indices are packed back to back and may span two longs
+        if (longs.size() * 64 < (size_t)ChunkSection::VOLUME * bits) {
+            throw std::runtime_error("Malformed section block states");
+        }
+        uint64_t mask = ((uint64_t)1 << bits) - 1;
+        for (int i = 0; i < ChunkSection::VOLUME; i++) {
+            size_t bit = (size_t)i * bits;
+            size_t word = bit >> 6;
+            int shift = bit & 63;
+            uint64_t value = longs[word] >> shift;
+            if (shift + bits > 64) {
+                value |= longs[word + 1] << (64 - shift);
+            }
+            value &= mask;
+            if (value >= data.palette.size()) {
+                throw std::runtime_error("Block state index outside section palette");
+            }
+            BlockId id = data.palette[value];
+            if (id != 0) {
+                section->set(i & 15, i >> 8, (i >> 4) & 15, id);
+            }
+        }
+        return section;
+    }
+
+    if (data.blocks) {
+        // Pre-1.13 numeric IDs, optionally extended by a high nibble
+        section = std::make_unique<ChunkSection>();
+        for (int i = 0; i < ChunkSection::VOLUME; i++) {
+            BlockId id = data.blocks[i];
+            if (data.add) {
+                id |= (BlockId)((data.add[i >> 1] >> ((i & 1) * 4)) & 15) << 8;
+            }
+            if (id != 0) {
+                section->set(i & 15, i >> 8, (i >> 4) & 15, id);
+            }
+        }
+    }
+    return section;
+}
+
+bool endsWith(const std::string& s, const char* suffix) {
+    size_t n = std::strlen(suffix);
+    return s.size() >= n && s.compare(s.size() - n, n, suffix) == 0;
+}
+
+}
+
+AnvilWorld::AnvilWorld(const std::string& world_dir) : region_dir(world_dir + "/region") {
+    struct stat st;
+    if (stat(region_dir.c_str(), &st) != 0 || !S_ISDIR(st.st_mode)) {
+        throw std::runtime_error("No region directory in world save " + world_dir);
+    }
+}
+
+AnvilWorld::~AnvilWorld() {
+    for (auto& entry : files) {
+        if (entry.second.data) {
+            munmap((void*)entry.second.data, entry.second.size);
+        }
+    }
+}
+
+/**
+ * Map region file (rx, rz) on first use. A missing file maps to an empty entry.
+ */
+const AnvilWorld::MappedFile& AnvilWorld::regionFile(int rx, int rz) {
+    auto it = files.find(std::make_pair(rx, rz));
+    if (it != files.end()) {
+        return it->second;
+    }
+
+    MappedFile file;
+    std::string path = region_dir + "/r." + std::to_string(rx) + "." + std::to_string(rz) + ".mca";
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd >= 0) {
+        struct stat st;
+        if (fstat(fd, &st) == 0 && st.st_size >= 2 * SECTOR_BYTES) {
+            void* data = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (data != MAP_FAILED) {
+                file.data = (const uint8_t*)data;
+                file.size = st.st_size;
+            }
+        }
+        close(fd);
+    }
+    return files.emplace(std::make_pair(rx, rz), file).first->second;
+}
+
+/**
+ * Decompress chunk (cx, cz) of a mapped region file into the inflated buffer.
+ * Returns false if the chunk is not present.
+ */
+bool AnvilWorld::inflateChunk(const MappedFile& file, int cx, int cz) {
+    if (!file.data) {
+        return false;
+    }
+    const uint8_t* entry = file.data + 4 * ((cx & 31) + (cz & 31) * 32);
+    size_t sector = (size_t)entry[0] << 16 | (size_t)entry[1] << 8 | entry[2];
+    if (sector == 0 || entry[3] == 0) {
+        return false;
+    }
+
+    size_t start = sector * SECTOR_BYTES;
+    if (start + 5 > file.size) {
+        throw std::runtime_error("Chunk offset outside region file");
+    }
+    const uint8_t* header = file.data + start;
+    size_t length = (size_t)header[0] << 24 | (size_t)header[1] << 16 | (size_t)header[2] << 8 | header[3];
+    uint8_t compression = header[4];
+    if (length < 1 || start + 4 + length > file.size) {
+        throw std::runtime_error("Chunk length outside region file");
+    }
+    const uint8_t* payload = header + 5;
+    size_t payload_size = length - 1;
+
+    if (compression == 3) {
+        inflated.assign(payload, payload + payload_size);
+    } else if (compression == 1 || compression == 2) {
+        if (inflated.size() < payload_size * 4) {
+            inflated.resize(payload_size * 4);
+        }
+        z_stream stream;
+        std::memset(&stream, 0, sizeof(stream));
+        if (inflateInit2(&stream, 15 + 32) != Z_OK) {   // accept zlib or gzip headers
+            throw std::runtime_error("Could not initialise zlib");
+        }
+        stream.next_in = (Bytef*)payload;
+        stream.avail_in = (uInt)payload_size;
+        size_t produced = 0;
+        int status;
+        do {
+            if (produced == inflated.size()) {
+                inflated.resize(inflated.size() * 2);
+            }
+            stream.next_out = inflated.data() + produced;
+            stream.avail_out = (uInt)(inflated.size() - produced);
+            status = inflate(&stream, Z_NO_FLUSH);
+            produced = inflated.size() - stream.avail_out;
+        } while (status == Z_OK);
+        inflateEnd(&stream);
+        if (status != Z_STREAM_END) {
+            throw std::runtime_error("Corrupt compressed chunk data");
+        }
+        inflated.resize(produced);
+    } else if (compression & 0x80) {
+        throw std::runtime_error("Oversized chunks stored in .mcc files are not supported");
+    } else {
+        throw std::runtime_error("Unsupported chunk compression type " + std::to_string(compression));
+    }
+
+    bytes_inflated += inflated.size();
+    return true;
+}
+
+bool AnvilWorld::loadChunk(int cx, int cz, VoxelRegion& out) {
+    const MappedFile& file = regionFile(cx >> 5, cz >> 5);
+    if (!inflateChunk(file, cx, cz)) {
+        out.markChunkLoaded(cx, cz);
+        return false;
+    }
+
+    NbtReader in(inflated.data(), inflated.size());
+    if (in.byte() != TAG_COMPOUND) {
+        throw std::runtime_error("Chunk NBT root is not a compound");
+    }
+    in.string();
+    ChunkData chunk;
+    readChunk(in, chunk, 0);
+
+    for (const SectionData& data : chunk.sections) {
+        if (data.y < 0 || data.y >= VoxelRegion::SECTIONS_PER_COLUMN) {
+            continue;
+        }
+        out.storeSection(cx, cz, data.y, buildSection(data, chunk.data_version));
+    }
+    out.markChunkLoaded(cx, cz);
+    chunks_decoded++;
+    return true;
+}
+
+size_t AnvilWorld::loadArea(int min_x, int min_z, int max_x, int max_z, VoxelRegion& out) {
+    size_t loaded = 0;
+    for (int cz = min_z >> 4; cz <= max_z >> 4; cz++) {
+        for (int cx = min_x >> 4; cx <= max_x >> 4; cx++) {
+            if (loadChunk(cx, cz, out)) {
+                loaded++;
+            }
+        }
+    }
+    return loaded;
+}
+
+BlockId AnvilWorld::legacyId(const std::string& name) {
+    static const std::unordered_map<std::string, BlockId> ids = {
+        {"air", 0}, {"cave_air", 0}, {"void_air", 0},
+        {"stone", 1}, {"granite", 1}, {"diorite", 1}, {"andesite", 1},
+        {"grass_block", 2}, {"dirt", 3}, {"coarse_dirt", 3}, {"podzol", 3},
+        {"cobblestone", 4}, {"bedrock", 7}, {"water", 9}, {"lava", 11},
+        {"sand", 12}, {"red_sand", 12}, {"gravel", 13},
+        {"gold_ore", 14}, {"iron_ore", 15}, {"coal_ore", 16},
+        {"acacia_log", 162}, {"dark_oak_log", 162}, {"acacia_wood", 162}, {"dark_oak_wood", 162},
+        {"acacia_leaves", 161}, {"dark_oak_leaves", 161},
+        {"sponge", 19}, {"glass", 20}, {"lapis_ore", 21}, {"sandstone", 24},
+        {"grass", 31}, {"short_grass", 31}, {"fern", 31}, {"dead_bush", 32},
+        {"dandelion", 37}, {"poppy", 38}, {"blue_orchid", 38}, {"allium", 38},
+        {"azure_bluet", 38}, {"red_tulip", 38}, {"orange_tulip", 38}, {"white_tulip", 38},
+        {"pink_tulip", 38}, {"oxeye_daisy", 38}, {"cornflower", 38}, {"lily_of_the_valley", 38},
+        {"brown_mushroom", 39}, {"red_mushroom", 40}, {"mossy_cobblestone", 48}, {"obsidian", 49},
+        {"farmland", 60}, {"snow", 78}, {"ice", 79}, {"snow_block", 80}, {"cactus", 81},
+        {"clay", 82}, {"sugar_cane", 83}, {"pumpkin", 86}, {"netherrack", 87},
+        {"vine", 106}, {"mycelium", 110}, {"lily_pad", 111}, {"terracotta", 172},
+        {"packed_ice", 174}, {"blue_ice", 174},
+        {"tall_grass", 175}, {"large_fern", 175}, {"sunflower", 175}, {"lilac", 175},
+        {"rose_bush", 175}, {"peony", 175}, {"red_sandstone", 179},
+        {"grass_path", 208}, {"dirt_path", 208}, {"magma_block", 213},
+        // Underwater plants stand in water, so treat them as water
+        {"seagrass", 9}, {"tall_seagrass", 9}, {"kelp", 9}, {"kelp_plant", 9}, {"bubble_column", 9},
+    };
+
+    std::string key = name.compare(0, 10, "minecraft:") == 0 ? name.substr(10) : name;
+    auto it = ids.find(key);
+    if (it != ids.end()) {
+        return it->second;
+    }
+    if (endsWith(key, "_log") || endsWith(key, "_wood") || endsWith(key, "_stem")) return 17;
+    if (endsWith(key, "_leaves")) return 18;
+    if (endsWith(key, "_planks")) return 5;
+    if (endsWith(key, "_sapling")) return 6;
+    if (endsWith(key, "_wool")) return 35;
+    if (endsWith(key, "_terracotta")) return 159;
+    return 1;
+}
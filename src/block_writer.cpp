@@ -0,0 +1,222 @@
+#include "block_writer.h"
+#include <chrono>
+#include <thread>
+
+BlockWriter::~BlockWriter() {
+    try {
+        flushChunks();
+    } catch (...) {
+        // The backend failed; whatever error stopped the run is already on its way out
+    }
+}
+
+void BlockWriter::setTargetLatency(double target_ms) {
+    flush();
+    std::lock_guard<std::mutex> lock(queue_mutex);
+    control = FlowController(target_ms);
+    enabled = target_ms > 0;
+}
+
+void BlockWriter::setBackend(WorldBackend* backend) {
+    flushChunks();
+    std::lock_guard<std::mutex> lock(queue_mutex);
+    sink = backend ? backend : &server;
+}
+
+void BlockWriter::setChunkOrdering(bool enabled) {
+    if (!enabled) {
+        flushChunks();
+    }
+    std::lock_guard<std::mutex> lock(queue_mutex);
+    chunk_ordered = enabled;
+}
+
+void BlockWriter::setBlock(const mcpp::Coordinate& pos, int block_id) {
+    std::unique_lock<std::mutex> lock(queue_mutex);
+    int64_t key = chunkKey(pos.x >> 4, pos.z >> 4);
+    if (has_issued && key != last_issued) {
+        issued_switches++;
+    }
+    has_issued = true;
+    last_issued = key;
+    
+    issue(pos, block_id, lock);
+}
+
+void BlockWriter::flush() {
+    std::unique_lock<std::mutex> lock(queue_mutex);
+    drain(0, lock);
+}
+
+void BlockWriter::flushChunks() {
+    std::unique_lock<std::mutex> lock(queue_mutex);
+    sendHeld(lock);
+    drain(0, lock);
+}
+
+/**
+ * Send batches until at most limit blocks are queued, waiting out the pause
+ * after each batch without holding the queue. Called with queue_mutex held.
+ */
+void BlockWriter::drain(size_t limit, std::unique_lock<std::mutex>& lock) {
+    while (pending.size() > limit) {
+        auto now = std::chrono::steady_clock::now();
+        auto resume = resume_at;
+        if (now < resume) {
+            lock.unlock();
+            std::this_thread::sleep_for(resume - now);
+            lock.lock();
+            continue;
+        }
+        sendBatch();
+    }
+}
+
+/**
+ * Hold an edit for its chunk in chunk-ordered mode, otherwise send it.
+ * Called with queue_mutex held.
+ */
+void BlockWriter::issue(const mcpp::Coordinate& pos, int block_id, std::unique_lock<std::mutex>& lock) {
+    if (chunk_ordered) {
+        int64_t key = chunkKey(pos.x >> 4, pos.z >> 4);
+        held[key].push_back(HeldEdit{(int16_t)pos.y, (uint8_t)(((pos.z & 15) << 4) | (pos.x & 15)), block_id});
+        return;
+    }
+    send(pos, block_id, lock);
+}
+
+/**
+ * Send one block now, or queue it for the next batch under flow control.
+ * A full queue makes the caller wait for room. Called with queue_mutex held.
+ */
+void BlockWriter::send(const mcpp::Coordinate& pos, int block_id, std::unique_lock<std::mutex>& lock) {
+    if (!enabled) {
+        {
+            std::lock_guard<std::mutex> io(*connection);
+            sink->setBlock(pos.x, pos.y, pos.z, (BlockId)block_id);
+        }
+        blocks++;
+        noteSent(pos);
+        return;
+    }
+    
+    drain(MAX_QUEUED - 1, lock);
+    pending.push_back(std::make_pair(pos, block_id));
+    if ((int)pending.size() >= control.batchSize() && std::chrono::steady_clock::now() >= resume_at) {
+        sendBatch();
+    }
+}
+
+/**
+ * Count chunk switches and distinct chunks in send order
+ */
+void BlockWriter::noteSent(const mcpp::Coordinate& pos) {
+    int64_t key = chunkKey(pos.x >> 4, pos.z >> 4);
+    if (has_sent && key == last_sent) {
+        return;
+    }
+    if (has_sent) {
+        chunk_switches++;
+    }
+    has_sent = true;
+    last_sent = key;
+    touched.insert(key);
+}
+
+/**
+ * Send every held chunk in Morton order. Within a chunk only the last edit
+ * to each position is sent, and edits keep the order they were issued in.
+ * Called with queue_mutex held; edits issued while it waits for room in the
+ * queue are held for the next call.
+ */
+void BlockWriter::sendHeld(std::unique_lock<std::mutex>& lock) {
+    std::unordered_map<int64_t, std::vector<HeldEdit>> chunks;
+    chunks.swap(held);
+    std::vector<std::pair<uint64_t, int64_t>> order;
+    order.reserve(chunks.size());
+    for (const auto& chunk : chunks) {
+        int cx = (int)(chunk.first >> 32);
+        int cz = (int32_t)(uint32_t)chunk.first;
+        order.push_back(std::make_pair(chunkMortonCode(cx, cz), chunk.first));
+    }
+    std::sort(order.begin(), order.end());
+    
+    std::vector<HeldEdit> kept;
+    for (const auto& entry : order) {
+        const std::vector<HeldEdit>& edits = chunks[entry.second];
+        int base_x = (int)(entry.second >> 32) * 16;
+        int base_z = (int32_t)(uint32_t)entry.second * 16;
+        
+        // Scan backwards so the first edit seen at a position is the one that stands
+        kept.clear();
+        for (auto it = edits.rbegin(); it != edits.rend(); ++it) {
+            if (it->y >= 0 && it->y < 256) {
+                size_t bit = (size_t)it->y << 8 | it->xz;
+                if (seen.test(bit)) {
+                    superseded++;
+                    continue;
+                }
+                seen.set(bit);
+            }
+            kept.push_back(*it);
+        }
+        for (const HeldEdit& edit : kept) {
+            if (edit.y >= 0 && edit.y < 256) {
+                seen.reset((size_t)edit.y << 8 | edit.xz);
+            }
+        }
+        for (auto it = kept.rbegin(); it != kept.rend(); ++it) {
+            send(mcpp::Coordinate(base_x + (it->xz & 15), it->y, base_z + (it->xz >> 4)), it->block_id, lock);
+        }
+    }
+}
+
+/**
+ * Send up to one batch of pending blocks, time them up to the answer to a
+ * read of the last one and start the pause the controller asks for. Called
+ * with queue_mutex held; the pause is waited out by drain(), never slept here.
+ */
+void BlockWriter::sendBatch() {
+    size_t count = std::min(pending.size(), (size_t)control.batchSize());
+    double elapsed_ms;
+    {
+        std::lock_guard<std::mutex> send(*connection);
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < count; i++) {
+            const auto& edit = pending[i];
+            sink->setBlock(edit.first.x, edit.first.y, edit.first.z, (BlockId)edit.second);
+        }
+        const mcpp::Coordinate& last = pending[count - 1].first;
+        sink->getBlock(last.x, last.y, last.z);
+        elapsed_ms = std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - start).count();
+    }
+    for (size_t i = 0; i < count; i++) {
+        noteSent(pending[i].first);
+    }
+    
+    blocks += count;
+    batches++;
+    control.record(elapsed_ms, (int)count);
+    pending.erase(pending.begin(), pending.begin() + count);
+    
+    resume_at = std::chrono::steady_clock::now() + std::chrono::microseconds(control.pauseMicros());
+    paused_ms += control.pauseMicros() / 1000.0;
+}
+
+WriteStats BlockWriter::stats() const {
+    std::lock_guard<std::mutex> lock(queue_mutex);
+    WriteStats s;
+    s.blocks = blocks;
+    s.batches = batches;
+    s.mean_latency_ms = control.smoothedLatency();
+    s.batch_size = control.batchSize();
+    s.pause_us = control.pauseMicros();
+    s.paused_ms = paused_ms;
+    s.queued = pending.size();
+    s.chunks = touched.size();
+    s.chunk_switches = chunk_switches;
+    s.issued_switches = issued_switches;
+    s.superseded = superseded;
+    return s;
+}
@@ -0,0 +1,256 @@
+#include "chunk_section.h"
+#include <algorithm>
+
+BlockId ChunkSection::get(int lx, int ly, int lz) const {
+    if (bits == 0) {
+        return palette[0];
+    }
+    return palette[readIndex(index(lx, ly, lz))];
+}
+
+void ChunkSection::set(int lx, int ly, int lz, BlockId id) {
+    BlockId old = get(lx, ly, lz);
+    if (old == id) {
+        return;
+    }
+    non_air += (id != 0) - (old != 0);
+    if (non_air == 0) {
+        // Written back to all air: drop the palette and data
+        palette.assign(1, 0);
+        std::vector<uint64_t>().swap(data);
+        bits = 0;
+        return;
+    }
+
+    int palette_index = -1;
+    for (size_t i = 0; i < palette.size(); i++) {
+        if (palette[i] == id) {
+            palette_index = (int)i;
+            break;
+        }
+    }
+
+    if (palette_index == -1) {
+        palette.push_back(id);
+        palette_index = (int)palette.size() - 1;
+        if (palette.size() > (size_t)1 << bits) {
+            // Anvil never packs with fewer than 4 bits per entry
+            resize(std::max(4, bits + 1));
+        }
+    }
+
+    writeIndex(index(lx, ly, lz), palette_index);
+}
+
+int ChunkSection::highestNonAir(int lx, int lz) const {
+    if (bits == 0) {
+        return palette[0] != 0 ? SIZE - 1 : -1;
+    }
+    for (int ly = SIZE - 1; ly >= 0; ly--) {
+        if (palette[readIndex(index(lx, ly, lz))] != 0) {
+            return ly;
+        }
+    }
+    return -1;
+}
+
+void ChunkSection::decodeColumn(int lx, int lz, BlockId* out) const {
+    if (bits == 0) {
+        std::fill(out, out + SIZE, palette[0]);
+        return;
+    }
+    for (int ly = 0; ly < SIZE; ly++) {
+        out[ly] = palette[readIndex(index(lx, ly, lz))];
+    }
+}
+
+bool ChunkSection::assignPacked(std::vector<BlockId>&& new_palette, std::vector<uint64_t>&& new_data,
+                                int new_bits) {
+    if (new_palette.empty()) {
+        return false;
+    }
+    if (new_palette.size() == 1) {
+        palette.swap(new_palette);
+        data.clear();
+        bits = 0;
+        non_air = palette[0] != 0 ? VOLUME : 0;
+        return true;
+    }
+    if (new_bits < 1 || new_bits > 16 || new_palette.size() > (size_t)1 << new_bits) {
+        return false;
+    }
+    int per_long = 64 / new_bits;
+    if (new_data.size() != (size_t)(VOLUME + per_long - 1) / per_long) {
+        return false;
+    }
+    palette.swap(new_palette);
+    data.swap(new_data);
+    bits = new_bits;
+
+    non_air = VOLUME;
+    if (std::find(palette.begin(), palette.end(), (BlockId)0) != palette.end()) {
+        for (int i = 0; i < VOLUME; i++) {
+            non_air -= palette[readIndex(i)] == 0;
+        }
+    }
+    return true;
+}
+
+size_t ChunkSection::memoryUsage() const {
+    return sizeof(ChunkSection) + palette.capacity() * sizeof(BlockId) +
+           data.capacity() * sizeof(uint64_t);
+}
+
+int ChunkSection::readIndex(int i) const {
+    int per_long = entriesPerLong();
+    uint64_t word = data[i / per_long];
+    int shift = (i % per_long) * bits;
+    return (int)((word >> shift) & ((1ULL << bits) - 1));
+}
+
+void ChunkSection::writeIndex(int i, int value) {
+    int per_long = entriesPerLong();
+    uint64_t mask = (1ULL << bits) - 1;
+    int shift = (i % per_long) * bits;
+    uint64_t& word = data[i / per_long];
+    word = (word & ~(mask << shift)) | (((uint64_t)value & mask) << shift);
+}
+
+void ChunkSection::resize(int new_bits) {
+    std::vector<uint64_t> old_data;
+    old_data.swap(data);
+    int old_bits = bits;
+
+    bits = new_bits;
+    int per_long = entriesPerLong();
+    data.assign((VOLUME + per_long - 1) / per_long, 0);
+
+    if (old_bits == 0) {
+        return; // every entry was palette index 0
+    }
+
+    int old_per_long = 64 / old_bits;
+    uint64_t old_mask = (1ULL << old_bits) - 1;
+    for (int i = 0; i < VOLUME; i++) {
+        uint64_t word = old_data[i / old_per_long];
+        writeIndex(i, (int)((word >> ((i % old_per_long) * old_bits)) & old_mask));
+    }
+}
+
+const VoxelRegion::ChunkColumn* VoxelRegion::findChunk(int x, int z) const {
+    auto it = chunks.find(chunkKey(x >> 4, z >> 4));
+    return it == chunks.end() ? nullptr : it->second.get();
+}
+
+VoxelRegion::ChunkColumn& VoxelRegion::chunkAt(int x, int z) {
+    std::unique_ptr<ChunkColumn>& chunk = chunks[chunkKey(x >> 4, z >> 4)];
+    if (!chunk) {
+        chunk.reset(new ChunkColumn());
+    }
+    return *chunk;
+}
+
+BlockId VoxelRegion::getBlock(int x, int y, int z) const {
+    if (y < 0 || y >= WORLD_HEIGHT) {
+        return 0;
+    }
+    const ChunkColumn* chunk = findChunk(x, z);
+    if (!chunk) {
+        return 0;
+    }
+    const ChunkSection* section = chunk->sections[y >> 4].get();
+    return section ? section->get(x & 15, y & 15, z & 15) : 0;
+}
+
+void VoxelRegion::setBlock(int x, int y, int z, BlockId id) {
+    if (y < 0 || y >= WORLD_HEIGHT) {
+        return;
+    }
+    if (id == 0) {
+        const ChunkColumn* existing = findChunk(x, z);
+        if (!existing || !existing->sections[y >> 4]) {
+            return; // all-air sections are stored as nothing
+        }
+    }
+    std::unique_ptr<ChunkSection>& section = chunkAt(x, z).sections[y >> 4];
+    if (!section) {
+        section.reset(new ChunkSection());
+    }
+    section->set(x & 15, y & 15, z & 15, id);
+    if (section->isAir()) {
+        section.reset();
+    }
+}
+
+int VoxelRegion::highestNonAir(int x, int z) const {
+    const ChunkColumn* chunk = findChunk(x, z);
+    if (!chunk) {
+        return -1;
+    }
+    for (int s = SECTIONS_PER_COLUMN - 1; s >= 0; s--) {
+        const ChunkSection* section = chunk->sections[s].get();
+        if (!section) {
+            continue;
+        }
+        int ly = section->highestNonAir(x & 15, z & 15);
+        if (ly >= 0) {
+            return s * ChunkSection::SIZE + ly;
+        }
+    }
+    return -1;
+}
+
+void VoxelRegion::decodeColumn(int x, int z, BlockId* out) const {
+    const ChunkColumn* chunk = findChunk(x, z);
+    for (int s = 0; s < SECTIONS_PER_COLUMN; s++) {
+        BlockId* dest = out + s * ChunkSection::SIZE;
+        const ChunkSection* section = chunk ? chunk->sections[s].get() : nullptr;
+        if (section) {
+            section->decodeColumn(x & 15, z & 15, dest);
+        } else {
+            std::fill(dest, dest + ChunkSection::SIZE, (BlockId)0);
+        }
+    }
+}
+
+void VoxelRegion::storeColumn(int x, int z, const BlockId* column) {
+    for (int y = 0; y < WORLD_HEIGHT; y++) {
+        setBlock(x, y, z, column[y]);
+    }
+    markColumnLoaded(x, z);
+}
+
+bool VoxelRegion::isColumnLoaded(int x, int z) const {
+    const ChunkColumn* chunk = findChunk(x, z);
+    return chunk && chunk->loaded.test(columnIndex(x, z));
+}
+
+void VoxelRegion::markColumnLoaded(int x, int z) {
+    chunkAt(x, z).loaded.set(columnIndex(x, z));
+}
+
+void VoxelRegion::storeSection(int cx, int cz, int sy, std::unique_ptr<ChunkSection> section) {
+    if (sy < 0 || sy >= SECTIONS_PER_COLUMN) {
+        return;
+    }
+    if (section && section->isAir()) {
+        section.reset();
+    }
+    chunkAt(cx << 4, cz << 4).sections[sy] = std::move(section);
+}
+
+void VoxelRegion::markChunkLoaded(int cx, int cz) {
+    chunkAt(cx << 4, cz << 4).loaded.set();
+}
+
+size_t VoxelRegion::memoryUsage() const {
+    size_t total = chunks.size() * (sizeof(ChunkColumn) + sizeof(int64_t) + sizeof(void*));
+    for (const auto& entry : chunks) {
+        for (const auto& section : entry.second->sections) {
+            if (section) {
+                total += section->memoryUsage();
+            }
+        }
+    }
+    return total;
+}
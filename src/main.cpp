@@ -3,6 +3,8 @@
 #include <string>
 #include <cstring>
 #include <ctime>
+#include <chrono>
+#include <memory>
 
 struct Options {
     int loc_x = 0;
@@ -11,6 +13,15 @@ struct Options {
     int plot_border = 10;
     int seed = time(nullptr);
     bool testmode = false;
+    bool stats = false;
+    bool paths = false;
+    bool pipeline = false;
+    bool chunk_order = false;
+    int scan_threads = 0;
+    double target_latency_ms = 0;
+    std::string biome = "default";
+    std::string world_dir;
+    bool plan_only = false;
     bool loc_set = false;
 };
 
@@ -20,6 +31,18 @@ bool parseOptions(int argc, char* argv[], Options& opts) {
         
         if (arg == "--testmode") {
             opts.testmode = true;
+        } else if (arg == "--stats") {
+            opts.stats = true;
+        } else if (arg == "--paths") {
+            opts.paths = true;
+        } else if (arg == "--pipeline") {
+            opts.pipeline = true;
+        } else if (arg == "--chunk-order") {
+            opts.chunk_order = true;
+        } else if (arg == "--plan-only") {
+            opts.plan_only = true;
+        } else if (arg.substr(0, 8) == "--world=") {
+            opts.world_dir = arg.substr(8);
         } else if (arg.substr(0, 6) == "--loc=") {
             std::string coords = arg.substr(6);
             size_t comma = coords.find(',');
@@ -42,6 +65,25 @@ bool parseOptions(int argc, char* argv[], Options& opts) {
                 std::cerr << "Error: plot-border must be non-negative" << std::endl;
                 return false;
             }
+        } else if (arg.substr(0, 17) == "--target-latency=") {
+            opts.target_latency_ms = std::stod(arg.substr(17));
+            if (opts.target_latency_ms < 0) {
+                std::cerr << "Error: target-latency must be non-negative" << std::endl;
+                return false;
+            }
+        } else if (arg.substr(0, 15) == "--scan-threads=") {
+            opts.scan_threads = std::stoi(arg.substr(15));
+            if (opts.scan_threads < 0) {
+                std::cerr << "Error: scan-threads must be non-negative" << std::endl;
+                return false;
+            }
+        } else if (arg.substr(0, 8) == "--biome=") {
+            opts.biome = arg.substr(8);
+            PlotRuleConfig config;
+            if (!plotRulesForBiome(opts.biome, config)) {
+                std::cerr << "Error: Unknown biome " << opts.biome << std::endl;
+                return false;
+            }
         } else if (arg.substr(0, 7) == "--seed=") {
             opts.seed = std::stoi(arg.substr(7));
         } else {
@@ -49,9 +91,25 @@ bool parseOptions(int argc, char* argv[], Options& opts) {
             return false;
         }
     }
+    if (opts.plan_only && (opts.world_dir.empty() || !opts.loc_set)) {
+        std::cerr << "Error: --plan-only requires --world and --loc" << std::endl;
+        return false;
+    }
     return true;
 }
 
+/**
+ * Print scratch allocations made by one generation stage
+ */
+void printStageStats(const std::string& stage, const ArenaStats& before, const ArenaStats& after) {
+    std::cout << "  [stats] " << stage << ": "
+              << (after.scratch_allocations - before.scratch_allocations)
+              << " scratch allocations served by arena, "
+              << (after.heap_allocations - before.heap_allocations)
+              << " heap blocks (" << (after.heap_bytes - before.heap_bytes) << " bytes)"
+              << std::endl;
+}
+
 int main(int argc, char* argv[]) {
     Options opts;
     
@@ -63,7 +121,11 @@ int main(int argc, char* argv[]) {
         // Connect to Minecraft
         mcpp::setLoggingLevel(mcpp::INFO);
         
-        mcpp::Coordinate player_pos = mcpp::getPlayerPosition();
+        // A planning run reads terrain from disk and never talks to the server
+        mcpp::Coordinate player_pos;
+        if (!opts.loc_set) {
+            player_pos = mcpp::getPlayerPosition();
+        }
         
         // Use provided location or player location
         mcpp::Coordinate village_center = opts.loc_set ? 
@@ -78,24 +140,124 @@ int main(int argc, char* argv[]) {
         // Create village generator
         VillageGenerator generator(village_center, opts.village_size, 
                                    opts.plot_border, opts.seed, opts.testmode);
+        generator.setTargetLatency(opts.target_latency_ms);
+        generator.setChunkOrderedWrites(opts.chunk_order);
+        generator.setScanThreads(opts.scan_threads);
+        PlotRuleConfig rules;
+        plotRulesForBiome(opts.biome, rules);
+        generator.setRuleConfig(rules);
+        
+        // Read terrain from the world save's region files instead of the server
+        std::unique_ptr<AnvilWorld> world;
+        if (!opts.world_dir.empty()) {
+            world.reset(new AnvilWorld(opts.world_dir));
+            generator.setWorldSource(world.get());
+            auto load_start = std::chrono::steady_clock::now();
+            size_t chunks = generator.preloadTerrain();
+            auto load_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - load_start).count();
+            std::cout << "Loaded " << chunks << " chunks from " << opts.world_dir << std::endl;
+            if (opts.stats) {
+                std::cout << "  [stats] region files: " << world->chunksDecoded() << " chunks, "
+                          << world->bytesInflated() / 1024 << " KiB inflated in " << load_ms
+                          << " ms" << std::endl;
+            }
+        }
+        
+        if (opts.plan_only) {
+            std::cout << "Finding suitable plots..." << std::endl;
+            auto search_start = std::chrono::steady_clock::now();
+            PlotSet plots = generator.findPlots();
+            auto search_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - search_start).count();
+            std::cout << "Found " << plots.size() << " plots" << std::endl;
+            for (size_t i = 0; i < plots.size(); i++) {
+                mcpp::Coordinate entrance = plots.entrance(i);
+                std::cout << "  plot " << i << ": (" << plots.minX(i) << ", " << plots.minZ(i)
+                          << ") to (" << plots.maxX(i) << ", " << plots.maxZ(i) << ") at y="
+                          << plots.height(i) << ", entrance (" << entrance.x << ", "
+                          << entrance.z << ")" << std::endl;
+            }
+            if (opts.stats) std::cout << "  [stats] findPlots: " << search_ms << " ms" << std::endl;
+            return 0;
+        }
+        
+        PlotSet plots;
+        std::vector<mcpp::Coordinate> waypoints;
         
-        // Find plots
-        std::cout << "Finding suitable plots..." << std::endl;
-        std::vector<Plot> plots = generator.findPlots();
-        std::cout << "Found " << plots.size() << " plots" << std::endl;
+        if (opts.pipeline) {
+            // Overlap plot finding, terraforming and wall building
+            std::cout << "Finding plots, terraforming and building wall (pipelined)..." << std::endl;
+            PipelineTimings timings = generator.runPipelined(plots, waypoints);
+            std::cout << "Found " << plots.size() << " plots" << std::endl;
+            std::cout << "Placed " << waypoints.size() << " waypoints" << std::endl;
+            if (opts.stats) {
+                std::cout << "  [stats] pipeline: search done at " << timings.search_ms
+                          << " ms, terraform at " << timings.terraform_ms
+                          << " ms, wall at " << timings.wall_ms
+                          << " ms, waypoints at " << timings.waypoints_ms << " ms" << std::endl;
+            }
+        } else {
+            // Find plots
+            std::cout << "Finding suitable plots..." << std::endl;
+            plots = generator.findPlots();
+            std::cout << "Found " << plots.size() << " plots" << std::endl;
+            ArenaStats after_search = generator.getArenaStats();
+            if (opts.stats) printStageStats("findPlots", ArenaStats{0, 0, 0}, after_search);
+            
+            // Terraform
+            std::cout << "Terraforming land..." << std::endl;
+            generator.terraformPlots(plots);
+            ArenaStats after_terraform = generator.getArenaStats();
+            if (opts.stats) printStageStats("terraformPlots", after_search, after_terraform);
+            
+            // Build wall
+            std::cout << "Building village wall..." << std::endl;
+            generator.buildWall(plots);
+            ArenaStats after_wall = generator.getArenaStats();
+            if (opts.stats) printStageStats("buildWall", after_terraform, after_wall);
+            
+            // Place waypoints
+            std::cout << "Placing waypoints..." << std::endl;
+            waypoints = generator.placeWaypoints(plots);
+            std::cout << "Placed " << waypoints.size() << " waypoints" << std::endl;
+            if (opts.stats) printStageStats("placeWaypoints", after_wall, generator.getArenaStats());
+        }
         
-        // Terraform
-        std::cout << "Terraforming land..." << std::endl;
-        generator.terraformPlots(plots);
+        // Connect plot entrances to waypoints
+        if (opts.paths) {
+            std::cout << "Laying paths..." << std::endl;
+            auto path_start = std::chrono::steady_clock::now();
+            std::vector<std::vector<mcpp::Coordinate>> paths = generator.placePaths(plots, waypoints);
+            auto path_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - path_start).count();
+            size_t connected = 0;
+            for (const auto& path : paths) {
+                if (!path.empty()) connected++;
+            }
+            std::cout << "Connected " << connected << " of " << paths.size()
+                      << " plots to waypoints" << std::endl;
+            if (opts.stats) std::cout << "  [stats] placePaths: " << path_ms << " ms" << std::endl;
+        }
         
-        // Build wall
-        std::cout << "Building village wall..." << std::endl;
-        generator.buildWall(plots);
+        // Send edits held for chunk ordering; if a stage throws, the generator
+        // sends them as it is destroyed
+        if (opts.chunk_order) {
+            std::cout << "Writing edits chunk by chunk..." << std::endl;
+        }
+        generator.commitWrites();
         
-        // Place waypoints
-        std::cout << "Placing waypoints..." << std::endl;
-        std::vector<mcpp::Coordinate> waypoints = generator.placeWaypoints(plots);
-        std::cout << "Placed " << waypoints.size() << " waypoints" << std::endl;
+        if (opts.stats) {
+            WriteStats writes = generator.getWriteStats();
+            std::cout << "  [stats] writes: " << writes.blocks << " blocks in "
+                      << writes.batches << " batches, " << writes.mean_latency_ms
+                      << " ms/block, batch size " << writes.batch_size
+                      << ", paused " << writes.paused_ms << " ms" << std::endl;
+            std::cout << "  [stats] chunks: " << writes.chunks << " touched, "
+                      << writes.chunk_switches << " switches (" << writes.issued_switches
+                      << " in issue order), " << writes.superseded << " superseded edits dropped"
+                      << std::endl;
+        }
         
         std::cout << "Village generation complete!" << std::endl;
         
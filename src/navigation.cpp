@@ -0,0 +1,304 @@
+#include "navigation.h"
+#include <algorithm>
+#include <climits>
+#include <cstdlib>
+#include <functional>
+#include <queue>
+
+HierarchicalPathfinder::HierarchicalPathfinder(const WalkGrid& g, int size)
+    : grid(g), cluster_size(size) {
+    clusters_x = (grid.width() + cluster_size - 1) / cluster_size;
+    clusters_z = (grid.depth() + cluster_size - 1) / cluster_size;
+    
+    // Place transition nodes on every open run along each shared cluster border
+    for (int cz = 0; cz < clusters_z; cz++) {
+        for (int cx = 0; cx < clusters_x; cx++) {
+            int x0, z0, x1, z1;
+            clusterBounds(cz * clusters_x + cx, x0, z0, x1, z1);
+            
+            // East border: cells (x1, z) and (x1 + 1, z)
+            if (cx + 1 < clusters_x) {
+                bool in_run = false;
+                int run_start = 0;
+                for (int z = z0; z <= z1 + 1; z++) {
+                    bool open = z <= z1 && grid.canStep(x1, z, x1 + 1, z);
+                    // A run also ends where either side cannot step along the border
+                    bool joined = in_run && open &&
+                                  grid.canStep(x1, z - 1, x1, z) && grid.canStep(x1 + 1, z - 1, x1 + 1, z);
+                    if (in_run && !joined) {
+                        int mid = (run_start + z - 1) / 2;
+                        linkAcross(x1, mid, x1 + 1, mid);
+                        in_run = false;
+                    }
+                    if (open && !in_run) {
+                        in_run = true;
+                        run_start = z;
+                    }
+                }
+            }
+            
+            // South border: cells (x, z1) and (x, z1 + 1)
+            if (cz + 1 < clusters_z) {
+                bool in_run = false;
+                int run_start = 0;
+                for (int x = x0; x <= x1 + 1; x++) {
+                    bool open = x <= x1 && grid.canStep(x, z1, x, z1 + 1);
+                    bool joined = in_run && open &&
+                                  grid.canStep(x - 1, z1, x, z1) && grid.canStep(x - 1, z1 + 1, x, z1 + 1);
+                    if (in_run && !joined) {
+                        int mid = (run_start + x - 1) / 2;
+                        linkAcross(mid, z1, mid, z1 + 1);
+                        in_run = false;
+                    }
+                    if (open && !in_run) {
+                        in_run = true;
+                        run_start = x;
+                    }
+                }
+            }
+        }
+    }
+    
+    // Link transition nodes inside each cluster by their local path cost
+    std::vector<std::vector<int>> members(clusters_x * clusters_z);
+    for (size_t i = 0; i < nodes.size(); i++) {
+        members[nodes[i].cluster].push_back((int)i);
+    }
+    for (size_t c = 0; c < members.size(); c++) {
+        const std::vector<int>& group = members[c];
+        for (size_t i = 0; i < group.size(); i++) {
+            for (size_t j = i + 1; j < group.size(); j++) {
+                const Node& a = nodes[group[i]];
+                const Node& b = nodes[group[j]];
+                int cost = localSearch(a.x, a.z, b.x, b.z, (int)c, nullptr);
+                if (cost >= 0) {
+                    nodes[group[i]].edges.push_back(std::make_pair(group[j], cost));
+                    nodes[group[j]].edges.push_back(std::make_pair(group[i], cost));
+                }
+            }
+        }
+    }
+}
+
+int HierarchicalPathfinder::clusterOf(int x, int z) const {
+    int cx = (x - grid.minX()) / cluster_size;
+    int cz = (z - grid.minZ()) / cluster_size;
+    return cz * clusters_x + cx;
+}
+
+void HierarchicalPathfinder::clusterBounds(int cluster, int& x0, int& z0, int& x1, int& z1) const {
+    int cx = cluster % clusters_x;
+    int cz = cluster / clusters_x;
+    x0 = grid.minX() + cx * cluster_size;
+    z0 = grid.minZ() + cz * cluster_size;
+    x1 = std::min(x0 + cluster_size, grid.minX() + grid.width()) - 1;
+    z1 = std::min(z0 + cluster_size, grid.minZ() + grid.depth()) - 1;
+}
+
+int HierarchicalPathfinder::addNode(int x, int z) {
+    auto it = node_at.find(cellKey(x, z));
+    if (it != node_at.end()) {
+        return it->second;
+    }
+    Node node;
+    node.x = x;
+    node.z = z;
+    node.cluster = clusterOf(x, z);
+    nodes.push_back(node);
+    node_at[cellKey(x, z)] = (int)nodes.size() - 1;
+    return (int)nodes.size() - 1;
+}
+
+void HierarchicalPathfinder::linkAcross(int ax, int az, int bx, int bz) {
+    int a = addNode(ax, az);
+    int b = addNode(bx, bz);
+    int cost = grid.stepCost(ax, az, bx, bz);
+    nodes[a].edges.push_back(std::make_pair(b, cost));
+    nodes[b].edges.push_back(std::make_pair(a, cost));
+}
+
+/**
+ * Link a query node to every other node in its cluster
+ */
+void HierarchicalPathfinder::connectToCluster(int node) {
+    for (size_t i = 0; i < nodes.size(); i++) {
+        if ((int)i == node || nodes[i].cluster != nodes[node].cluster) continue;
+        int cost = localSearch(nodes[node].x, nodes[node].z, nodes[i].x, nodes[i].z,
+                               nodes[node].cluster, nullptr);
+        if (cost >= 0) {
+            nodes[node].edges.push_back(std::make_pair((int)i, cost));
+            nodes[i].edges.push_back(std::make_pair(node, cost));
+        }
+    }
+}
+
+/**
+ * Undo addNode/connectToCluster for the most recently added node
+ */
+void HierarchicalPathfinder::removeTemporaryNode(int node) {
+    for (const auto& edge : nodes[node].edges) {
+        std::vector<std::pair<int, int>>& back = nodes[edge.first].edges;
+        back.erase(std::remove_if(back.begin(), back.end(),
+                                  [node](const std::pair<int, int>& e) { return e.first == node; }),
+                   back.end());
+    }
+    node_at.erase(cellKey(nodes[node].x, nodes[node].z));
+    nodes.pop_back();
+}
+
+/**
+ * A* confined to one cluster. Returns the path cost, or -1 if unreachable.
+ * When path is given, the cells from start to goal are appended to it.
+ */
+int HierarchicalPathfinder::localSearch(int sx, int sz, int gx, int gz, int cluster,
+                                        std::vector<mcpp::Coordinate>* path) {
+    int x0, z0, x1, z1;
+    clusterBounds(cluster, x0, z0, x1, z1);
+    int cw = x1 - x0 + 1;
+    int area = cw * (z1 - z0 + 1);
+    
+    local_cost.assign(area, INT_MAX);
+    local_parent.assign(area, -1);
+    local_closed.assign(area, 0);
+    
+    typedef std::pair<int, int> Entry;   // (f, local index)
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> open;
+    
+    int start = (sz - z0) * cw + (sx - x0);
+    int goal = (gz - z0) * cw + (gx - x0);
+    local_cost[start] = 0;
+    open.push(std::make_pair(std::abs(gx - sx) + std::abs(gz - sz), start));
+    
+    const int DX[4] = {1, -1, 0, 0};
+    const int DZ[4] = {0, 0, 1, -1};
+    
+    while (!open.empty()) {
+        int current = open.top().second;
+        open.pop();
+        if (local_closed[current]) continue;
+        local_closed[current] = 1;
+        if (current == goal) break;
+        
+        int cx = x0 + current % cw;
+        int cz = z0 + current / cw;
+        for (int dir = 0; dir < 4; dir++) {
+            int nx = cx + DX[dir];
+            int nz = cz + DZ[dir];
+            if (nx < x0 || nx > x1 || nz < z0 || nz > z1) continue;
+            if (!grid.canStep(cx, cz, nx, nz)) continue;
+            
+            int next = (nz - z0) * cw + (nx - x0);
+            int cost = local_cost[current] + grid.stepCost(cx, cz, nx, nz);
+            if (cost < local_cost[next]) {
+                local_cost[next] = cost;
+                local_parent[next] = current;
+                open.push(std::make_pair(cost + std::abs(gx - nx) + std::abs(gz - nz), next));
+            }
+        }
+    }
+    
+    if (local_cost[goal] == INT_MAX) {
+        return -1;
+    }
+    
+    if (path) {
+        size_t first = path->size();
+        for (int cell = goal; cell != -1; cell = local_parent[cell]) {
+            int x = x0 + cell % cw;
+            int z = z0 + cell / cw;
+            path->push_back(mcpp::Coordinate(x, grid.height(x, z), z));
+        }
+        std::reverse(path->begin() + first, path->end());
+    }
+    return local_cost[goal];
+}
+
+/**
+ * A* over the abstract node graph
+ */
+bool HierarchicalPathfinder::abstractSearch(int start, int goal, std::vector<int>& route) {
+    std::vector<int> cost(nodes.size(), INT_MAX);
+    std::vector<int> parent(nodes.size(), -1);
+    std::vector<uint8_t> closed(nodes.size(), 0);
+    
+    typedef std::pair<int, int> Entry;   // (f, node)
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> open;
+    
+    const Node& target = nodes[goal];
+    cost[start] = 0;
+    open.push(std::make_pair(0, start));
+    
+    while (!open.empty()) {
+        int current = open.top().second;
+        open.pop();
+        if (closed[current]) continue;
+        closed[current] = 1;
+        if (current == goal) break;
+        
+        for (const auto& edge : nodes[current].edges) {
+            int next = edge.first;
+            int next_cost = cost[current] + edge.second;
+            if (next_cost < cost[next]) {
+                cost[next] = next_cost;
+                parent[next] = current;
+                int h = std::abs(target.x - nodes[next].x) + std::abs(target.z - nodes[next].z);
+                open.push(std::make_pair(next_cost + h, next));
+            }
+        }
+    }
+    
+    if (cost[goal] == INT_MAX) {
+        return false;
+    }
+    
+    route.clear();
+    for (int node = goal; node != -1; node = parent[node]) {
+        route.push_back(node);
+    }
+    std::reverse(route.begin(), route.end());
+    return true;
+}
+
+std::vector<mcpp::Coordinate> HierarchicalPathfinder::findPath(int from_x, int from_z,
+                                                               int to_x, int to_z) {
+    std::vector<mcpp::Coordinate> path;
+    if (!grid.walkable(from_x, from_z) || !grid.walkable(to_x, to_z)) {
+        return path;
+    }
+    
+    // Both ends in one cluster: a local search is usually enough
+    int from_cluster = clusterOf(from_x, from_z);
+    if (from_cluster == clusterOf(to_x, to_z) &&
+        localSearch(from_x, from_z, to_x, to_z, from_cluster, &path) >= 0) {
+        return path;
+    }
+    
+    // Insert the query ends into the abstract graph for this search only
+    size_t base_nodes = nodes.size();
+    int start = addNode(from_x, from_z);
+    if ((size_t)start >= base_nodes) connectToCluster(start);
+    int goal = addNode(to_x, to_z);
+    if ((size_t)goal >= base_nodes && goal != start) connectToCluster(goal);
+    
+    std::vector<int> route;
+    if (abstractSearch(start, goal, route)) {
+        path.push_back(mcpp::Coordinate(from_x, grid.height(from_x, from_z), from_z));
+        for (size_t i = 1; i < route.size(); i++) {
+            const Node& a = nodes[route[i - 1]];
+            const Node& b = nodes[route[i]];
+            if (a.cluster == b.cluster) {
+                // Refine the hop, dropping the cell already on the path
+                std::vector<mcpp::Coordinate> segment;
+                localSearch(a.x, a.z, b.x, b.z, a.cluster, &segment);
+                path.insert(path.end(), segment.begin() + 1, segment.end());
+            } else {
+                path.push_back(mcpp::Coordinate(b.x, grid.height(b.x, b.z), b.z));
+            }
+        }
+    }
+    
+    while (nodes.size() > base_nodes) {
+        removeTemporaryNode((int)nodes.size() - 1);
+    }
+    return path;
+}
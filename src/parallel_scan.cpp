@@ -0,0 +1,102 @@
+#include "village_generator.h"
+#include <exception>
+#include <thread>
+
+/**
+ * Run work(t) for t in [0, threads) on separate threads and rethrow the first
+ * error once every thread has finished
+ */
+static void runWorkers(unsigned threads, const std::function<void(unsigned)>& work) {
+    std::vector<std::exception_ptr> errors(threads);
+    std::vector<std::thread> workers;
+    workers.reserve(threads);
+    for (unsigned t = 0; t < threads; t++) {
+        workers.emplace_back([&, t]() {
+            try {
+                work(t);
+            } catch (...) {
+                errors[t] = std::current_exception();
+            }
+        });
+    }
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+    for (const std::exception_ptr& error : errors) {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+}
+
+/**
+ * Make sure the terrain rules for grid row `row` have been evaluated, speculating
+ * a band of rows starting there if not. The workers first read the surface under
+ * the band's footprints that earlier bands have not, then evaluate the band's
+ * points at every plot size, each on its own rule engine. Bands are only
+ * speculated as the serial scan reaches them, so a scan that stops early reads no
+ * terrain past its last band. Returns false when only one scan thread is
+ * available, leaving the caller to check points as it reaches them.
+ */
+bool VillageGenerator::speculateGridRows(GridSpeculation& grid, int row) {
+    const int BAND_ROWS = 4;
+
+    unsigned threads = scan_threads ? scan_threads : std::thread::hardware_concurrency();
+    if (threads <= 1 || row >= grid.rows) {
+        return false;
+    }
+    if (row < grid.speculated_rows) {
+        return true;
+    }
+
+    // Footprints of size s centred on c span [c - s/2, c - s/2 + s - 1], so grid row r
+    // covers surface rows [r * step, r * step + max_size - 1]
+    int band_end = std::min(grid.rows, row + BAND_ROWS);
+    int surface_begin = std::max(grid.surface_rows, row * grid.step);
+    int surface_end = (band_end - 1) * grid.step + grid.max_size;
+    int surface_min_x = grid.first_x - grid.max_size / 2;
+    int surface_min_z = grid.first_z - grid.max_size / 2;
+
+    const BlockClassTable& classes = *rule_config.classes;
+    unsigned readers = std::min(threads, (unsigned)(surface_end - surface_begin));
+    runWorkers(readers, [&](unsigned t) {
+        for (int r = surface_begin + (int)t; r < surface_end; r += readers) {
+            int z = surface_min_z + r;
+            for (int c = 0; c < grid.surface_width; c++) {
+                int x = surface_min_x + c;
+                int y = getHighestBlock(x, z).y;
+                BlockId block = terrainBlock(x, y, z);
+                grid.surface[(size_t)r * grid.surface_width + c] = SurfaceCell{y, block, classes.lookup(block)};
+            }
+        }
+    });
+    grid.surface_rows = surface_end;
+
+    size_t first_point = (size_t)row * grid.columns;
+    size_t points = (size_t)(band_end - row) * grid.columns;
+    unsigned evaluators = std::min<size_t>(threads, points);
+    runWorkers(evaluators, [&](unsigned t) {
+        DefaultPlotRules rules;
+        auto cell_at = [&](int x, int z) {
+            return grid.surface[(size_t)(z - surface_min_z) * grid.surface_width + (x - surface_min_x)];
+        };
+        // Interleave points so every thread gets a share of each part of the band
+        for (size_t point = first_point + t; point < first_point + points; point += evaluators) {
+            int center_x = grid.first_x + (int)(point % grid.columns) * grid.step;
+            int center_z = grid.first_z + (int)(point / grid.columns) * grid.step;
+            uint8_t bits = 0;
+            for (int size = grid.min_size; size <= grid.max_size; size++) {
+                int origin_x = center_x - size / 2;
+                int origin_z = center_z - size / 2;
+                if (rules.evaluate(rule_config, origin_x, origin_z,
+                                   origin_x + size - 1, origin_z + size - 1, cell_at)) {
+                    bits |= (uint8_t)(1 << (size - grid.min_size));
+                }
+            }
+            grid.fits[point] = bits;
+        }
+    });
+    grid.speculated_rows = band_end;
+
+    return true;
+}
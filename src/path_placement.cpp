@@ -0,0 +1,87 @@
+#include "village_generator.h"
+#include <algorithm>
+
+/**
+ * Build the walkability grid for the village area from the terrain cache.
+ * Water surfaces and plot interiors are blocked; slopes are handled by the
+ * grid's one-block step rule.
+ */
+WalkGrid VillageGenerator::buildWalkGrid(const PlotSet& plots) {
+    int village_min_x = village_center.x - village_size / 2;
+    int village_max_x = village_center.x + village_size / 2;
+    int village_min_z = village_center.z - village_size / 2;
+    int village_max_z = village_center.z + village_size / 2;
+    
+    WalkGrid grid(village_min_x, village_min_z,
+                  village_max_x - village_min_x + 1, village_max_z - village_min_z + 1);
+    
+    for (int z = village_min_z; z <= village_max_z; z++) {
+        for (int x = village_min_x; x <= village_max_x; x++) {
+            int y = worldHeight(x, z);
+            int surface = worldBlock(x, y, z);
+            bool water = surface == 8 || surface == 9;
+            grid.setCell(x, z, y, y >= 0 && !water && !plots.containsAny(x, z));
+        }
+    }
+    return grid;
+}
+
+/**
+ * Connect each plot entrance to its nearest waypoint
+ */
+std::vector<std::vector<mcpp::Coordinate>> VillageGenerator::placePaths(
+        const PlotSet& plots, const std::vector<mcpp::Coordinate>& waypoints) {
+    const int PATH_BLOCK_ID = 13; // Gravel
+    
+    std::vector<std::vector<mcpp::Coordinate>> paths(plots.size());
+    if (waypoints.empty()) {
+        return paths;
+    }
+    
+    WalkGrid grid = buildWalkGrid(plots);
+    HierarchicalPathfinder pathfinder(grid);
+    
+    for (size_t i = 0; i < plots.size(); i++) {
+        // Start on the cell just outside the entrance, since plot interiors are blocked
+        mcpp::Coordinate entrance = plots.entrance(i);
+        int start_x = entrance.x;
+        int start_z = entrance.z;
+        if (entrance.z == plots.minZ(i)) start_z--;
+        else if (entrance.z == plots.maxZ(i)) start_z++;
+        else if (entrance.x == plots.minX(i)) start_x--;
+        else if (entrance.x == plots.maxX(i)) start_x++;
+        
+        // Nearest waypoint by straight-line distance
+        size_t nearest = 0;
+        long best = -1;
+        for (size_t w = 0; w < waypoints.size(); w++) {
+            long dx = waypoints[w].x - start_x;
+            long dz = waypoints[w].z - start_z;
+            if (best < 0 || dx * dx + dz * dz < best) {
+                best = dx * dx + dz * dz;
+                nearest = w;
+            }
+        }
+        
+        paths[i] = pathfinder.findPath(start_x, start_z, waypoints[nearest].x, waypoints[nearest].z);
+    }
+    
+    // Lay all path blocks in one batch, once per cell, in x-then-z order
+    std::vector<mcpp::Coordinate> blocks;
+    for (const auto& path : paths) {
+        blocks.insert(blocks.end(), path.begin(), path.end());
+    }
+    std::sort(blocks.begin(), blocks.end(), [](const mcpp::Coordinate& a, const mcpp::Coordinate& b) {
+        return a.x != b.x ? a.x < b.x : a.z < b.z;
+    });
+    blocks.erase(std::unique(blocks.begin(), blocks.end(), [](const mcpp::Coordinate& a, const mcpp::Coordinate& b) {
+        return a.x == b.x && a.z == b.z;
+    }), blocks.end());
+    
+    for (const auto& block : blocks) {
+        placeBlock(block, PATH_BLOCK_ID);
+    }
+    writer.flush();
+    
+    return paths;
+}
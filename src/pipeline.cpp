@@ -0,0 +1,123 @@
+#include "village_generator.h"
+#include "bounded_queue.h"
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <thread>
+
+/**
+ * Run the generation stages with overlap:
+ * - accepted plots go to a terraforming worker through a queue, starting once enough
+ *   plots have been found that the search can no longer come up short
+ * - the wall starts once the search has finished and every plot whose border reaches
+ *   the perimeter has been terraformed, unless terraforming has already failed, and
+ *   runs alongside the rest of terraforming
+ * - waypoints are placed once terraforming and the wall are done
+ * Plots are terraformed one at a time in acceptance order, and no other plot's border
+ * reaches the perimeter columns, so every column sees its edits in the same order as
+ * the sequential stages. A read failure late in the search, or a terraforming failure
+ * once the wall has started, leaves the edits already made in place, as a connection
+ * dropped part way through any stage does.
+ */
+PipelineTimings VillageGenerator::runPipelined(PlotSet& plots, std::vector<mcpp::Coordinate>& waypoints) {
+    // Room for every plot the search can accept, so it never waits on terraforming
+    const size_t QUEUE_CAPACITY = 100;
+    
+    auto start = std::chrono::steady_clock::now();
+    auto elapsed_ms = [start]() {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    };
+    PipelineTimings timings = {0, 0, 0, 0};
+    
+    BoundedQueue<Plot> queue(QUEUE_CAPACITY);
+    std::mutex progress_mutex;
+    std::condition_variable progress;
+    size_t terraformed = 0;
+    bool terraform_finished = false;
+    bool terraform_failed = false;
+    std::exception_ptr terraform_error;
+    std::exception_ptr wall_error;
+    size_t queue_fed = 0;
+    
+    std::thread terraformer([&]() {
+        try {
+            Plot plot;
+            while (queue.pop(plot)) {
+                terraformPlot(plot);
+                std::lock_guard<std::mutex> lock(progress_mutex);
+                terraformed++;
+                progress.notify_all();
+            }
+            writer.flush();
+        } catch (...) {
+            terraform_error = std::current_exception();
+            queue.close(); // unblock the search if it is waiting on a full queue
+        }
+        timings.terraform_ms = elapsed_ms();
+        std::lock_guard<std::mutex> lock(progress_mutex);
+        terraform_finished = true;
+        terraform_failed = terraform_error != nullptr;
+        progress.notify_all();
+    });
+    
+    // A search that finds too few plots throws before the sequential stages write
+    // anything, so the first plots are held back until that can no longer happen
+    const size_t min_plots = minPlotCount();
+    std::vector<Plot> held;
+    try {
+        plots = findPlots([&](const Plot& plot) {
+            held.push_back(plot);
+            if (held.size() + queue_fed >= min_plots) {
+                for (const Plot& p : held) queue.push(p);
+                queue_fed += held.size();
+                held.clear();
+            }
+        });
+    } catch (...) {
+        queue.close();
+        terraformer.join();
+        throw;
+    }
+    queue.close();
+    timings.search_ms = elapsed_ms();
+    
+    // The wall samples and writes perimeter columns, so it must follow the last
+    // plot whose terraformed border reaches the perimeter
+    int village_min_x = village_center.x - village_size / 2;
+    int village_max_x = village_center.x + village_size / 2;
+    int village_min_z = village_center.z - village_size / 2;
+    int village_max_z = village_center.z + village_size / 2;
+    size_t wall_after = 0;
+    for (size_t i = 0; i < plots.size(); i++) {
+        if (plots.minX(i) - plot_border <= village_min_x || plots.maxX(i) + plot_border >= village_max_x ||
+            plots.minZ(i) - plot_border <= village_min_z || plots.maxZ(i) + plot_border >= village_max_z) {
+            wall_after = i + 1;
+        }
+    }
+    
+    std::thread wall_builder([&, wall_after]() {
+        {
+            std::unique_lock<std::mutex> lock(progress_mutex);
+            progress.wait(lock, [&]() { return terraformed >= wall_after || terraform_finished; });
+            if (terraformed < wall_after || terraform_failed) {
+                return; // terraforming failed; its error is reported below
+            }
+        }
+        try {
+            buildWall(plots);
+        } catch (...) {
+            wall_error = std::current_exception();
+        }
+        timings.wall_ms = elapsed_ms();
+    });
+    
+    terraformer.join();
+    wall_builder.join();
+    if (terraform_error) std::rethrow_exception(terraform_error);
+    if (wall_error) std::rethrow_exception(wall_error);
+    writer.flush();
+    
+    waypoints = placeWaypoints(plots);
+    timings.waypoints_ms = elapsed_ms();
+    return timings;
+}
@@ -3,77 +3,32 @@
 #include <algorithm>
 
 /**
- * Get the highest non-air block at coordinates (x, z)
+ * Check water coverage and slope delta (excluding trees) in one pass over the
+ * plot, stopping as soon as either rule can no longer be met
  */
-mcpp::Coordinate VillageGenerator::getHighestBlock(int x, int z) {
-    for (int y = 255; y >= 0; y--) {
-        mcpp::Block block = mcpp::getBlock(mcpp::Coordinate(x, y, z));
-        if (block.id != 0) { // 0 is air
-            return mcpp::Coordinate(x, y, z);
-        }
-    }
-    return mcpp::Coordinate(x, 0, z);
-}
-
-/**
- * Check if water coverage is <= 15% (max 3 water blocks in 20x20 area)
- */
-bool VillageGenerator::checkWaterCoverage(const Plot& plot) {
-    int water_count = 0;
-    int total_blocks = plot.getWidth() * plot.getDepth();
-    
-    for (int x = plot.origin.x; x <= plot.bound.x; x++) {
-        for (int z = plot.origin.z; z <= plot.bound.z; z++) {
-            mcpp::Coordinate highest = getHighestBlock(x, z);
-            mcpp::Block block = mcpp::getBlock(highest);
-            
-            // Check for water (block id 8 or 9 for flowing/stationary water)
-            if (block.id == 8 || block.id == 9) {
-                water_count++;
-            }
-        }
-    }
-    
-    double water_percentage = (double)water_count / total_blocks;
-    return water_percentage <= 0.15;
-}
-
-/**
- * Check if slope delta is <= 15 (excluding trees)
- */
-bool VillageGenerator::checkSlopeDelta(const Plot& plot) {
-    int min_height = 255;
-    int max_height = 0;
-    
-    for (int x = plot.origin.x; x <= plot.bound.x; x++) {
-        for (int z = plot.origin.z; z <= plot.bound.z; z++) {
-            mcpp::Coordinate highest = getHighestBlock(x, z);
-            int y = highest.y;
-            
-            // Skip tree blocks (leaves: 18, wood: 17)
-            mcpp::Block block = mcpp::getBlock(highest);
-            if (block.id != 18 && block.id != 17) {
-                min_height = std::min(min_height, y);
-                max_height = std::max(max_height, y);
-            }
-        }
-    }
+bool VillageGenerator::checkTerrainRules(const Plot& plot) {
+    const BlockClassTable& classes = *rule_config.classes;
     
-    return (max_height - min_height) <= 15;
+    return plot_rules.evaluate(rule_config, plot.minX(), plot.minZ(), plot.maxX(), plot.maxZ(),
+        [&](int x, int z) {
+            int y = getHighestBlock(x, z).y;
+            BlockId block = terrainBlock(x, y, z);
+            return SurfaceCell{y, block, classes.lookup(block)};
+        });
 }
 
 /**
  * Check if plot border intersects with other plot borders or walls
  */
 bool VillageGenerator::checkBorderIntersection(const Plot& plot, 
-                                               const std::vector<Plot>& existing_plots) {
+                                               const PlotSet& existing_plots) {
     // Check against existing plots
     for (const auto& other : existing_plots) {
         // Check if borders intersect (but plots themselves don't)
-        int border_min_x = plot.origin.x - plot_border;
-        int border_max_x = plot.bound.x + plot_border;
-        int border_min_z = plot.origin.z - plot_border;
-        int border_max_z = plot.bound.z + plot_border;
+        int border_min_x = plot.minX() - plot_border;
+        int border_max_x = plot.maxX() + plot_border;
+        int border_min_z = plot.minZ() - plot_border;
+        int border_max_z = plot.maxZ() + plot_border;
         
         // If borders overlap but plots don't, that's allowed
         // We just need to ensure the actual plots don't intersect
@@ -86,15 +41,10 @@ bool VillageGenerator::checkBorderIntersection(const Plot& plot,
  * Check if plot intersects with other plots
  */
 bool VillageGenerator::checkPlotIntersection(const Plot& plot, 
-                                             const std::vector<Plot>& existing_plots) {
-    for (const auto& other : existing_plots) {
-        // Check for AABB intersection
-        if (!(plot.bound.x < other.origin.x || plot.origin.x > other.bound.x ||
-              plot.bound.z < other.origin.z || plot.origin.z > other.bound.z)) {
-            return false; // Intersection found
-        }
-    }
-    return true;
+                                             const PlotSet& existing_plots) {
+    // AABB intersection against every existing plot in one branch-free pass
+    return !existing_plots.intersectsAny(plot.minX(), plot.minZ(),
+                                         plot.maxX(), plot.maxZ());
 }
 
 /**
@@ -104,33 +54,34 @@ mcpp::Coordinate VillageGenerator::selectEntrance(const Plot& plot) {
     // Find which edge is closest to village center
     int center_x = village_center.x;
     int center_z = village_center.z;
-    int plot_center_x = (plot.origin.x + plot.bound.x) / 2;
-    int plot_center_z = (plot.origin.z + plot.bound.z) / 2;
+    int plot_center_x = (plot.minX() + plot.maxX()) / 2;
+    int plot_center_z = (plot.minZ() + plot.maxZ()) / 2;
     
-    std::vector<mcpp::Coordinate> candidates;
+    std::pmr::vector<mcpp::Coordinate> candidates(arena.resource());
+    candidates.reserve(2 * (plot.getWidth() + plot.getDepth()));
     
     // North edge (min z)
     if (plot_center_z > center_z) {
-        for (int x = plot.origin.x + 1; x < plot.bound.x; x++) {
-            candidates.push_back(mcpp::Coordinate(x, 0, plot.origin.z));
+        for (int x = plot.minX() + 1; x < plot.maxX(); x++) {
+            candidates.push_back(mcpp::Coordinate(x, 0, plot.minZ()));
         }
     }
     // South edge (max z)
     if (plot_center_z < center_z) {
-        for (int x = plot.origin.x + 1; x < plot.bound.x; x++) {
-            candidates.push_back(mcpp::Coordinate(x, 0, plot.bound.z));
+        for (int x = plot.minX() + 1; x < plot.maxX(); x++) {
+            candidates.push_back(mcpp::Coordinate(x, 0, plot.maxZ()));
         }
     }
     // West edge (min x)
     if (plot_center_x > center_x) {
-        for (int z = plot.origin.z + 1; z < plot.bound.z; z++) {
-            candidates.push_back(mcpp::Coordinate(plot.origin.x, 0, z));
+        for (int z = plot.minZ() + 1; z < plot.maxZ(); z++) {
+            candidates.push_back(mcpp::Coordinate(plot.minX(), 0, z));
         }
     }
     // East edge (max x)
     if (plot_center_x < center_x) {
-        for (int z = plot.origin.z + 1; z < plot.bound.z; z++) {
-            candidates.push_back(mcpp::Coordinate(plot.bound.x, 0, z));
+        for (int z = plot.minZ() + 1; z < plot.maxZ(); z++) {
+            candidates.push_back(mcpp::Coordinate(plot.maxX(), 0, z));
         }
     }
     
@@ -146,14 +97,9 @@ mcpp::Coordinate VillageGenerator::selectEntrance(const Plot& plot) {
 /**
  * Validate a single plot against all constraints
  */
-bool VillageGenerator::isValidPlot(const Plot& plot, const std::vector<Plot>& existing_plots) {
-    // Check water coverage
-    if (!checkWaterCoverage(plot)) {
-        return false;
-    }
-    
-    // Check slope delta
-    if (!checkSlopeDelta(plot)) {
+bool VillageGenerator::isValidPlot(const Plot& plot, const PlotSet& existing_plots) {
+    // Check water coverage and slope delta
+    if (!checkTerrainRules(plot)) {
         return false;
     }
     
@@ -163,15 +109,22 @@ bool VillageGenerator::isValidPlot(const Plot& plot, const std::vector<Plot>& ex
     }
     
     // Check border intersection with village boundary
+    return checkVillageBounds(plot);
+}
+
+/**
+ * Check that the plot's terraformed border lies inside the village
+ */
+bool VillageGenerator::checkVillageBounds(const Plot& plot) {
     int village_min_x = village_center.x - village_size / 2;
     int village_max_x = village_center.x + village_size / 2;
     int village_min_z = village_center.z - village_size / 2;
     int village_max_z = village_center.z + village_size / 2;
     
-    int border_min_x = plot.origin.x - plot_border;
-    int border_max_x = plot.bound.x + plot_border;
-    int border_min_z = plot.origin.z - plot_border;
-    int border_max_z = plot.bound.z + plot_border;
+    int border_min_x = plot.minX() - plot_border;
+    int border_max_x = plot.maxX() + plot_border;
+    int border_min_z = plot.minZ() - plot_border;
+    int border_max_z = plot.maxZ() + plot_border;
     
     if (border_min_x < village_min_x || border_max_x > village_max_x ||
         border_min_z < village_min_z || border_max_z > village_max_z) {
@@ -184,12 +137,23 @@ bool VillageGenerator::isValidPlot(const Plot& plot, const std::vector<Plot>& ex
 /**
  * Find all valid plots in the village area
  */
-std::vector<Plot> VillageGenerator::findPlots() {
-    std::vector<Plot> plots;
+PlotSet VillageGenerator::findPlots() {
+    return findPlots([](const Plot&) {});
+}
+
+/**
+ * Find all valid plots, passing each one to on_accept as soon as it is accepted
+ */
+PlotSet VillageGenerator::findPlots(const std::function<void(const Plot&)>& on_accept) {
+    // findPlots starts a new job: drop the previous job's scratch buffers
+    arena.reset();
+    
+    PlotSet plots;
+    plots.reserve(100);
     const int MAX_ATTEMPTS = 1000;
     const int MIN_PLOT_SIZE = 14;
     const int MAX_PLOT_SIZE = 20;
-    const int MIN_PLOTS = std::max(1, village_size / 50);
+    const int MIN_PLOTS = minPlotCount();
     
     int village_min_x = village_center.x - village_size / 2;
     int village_max_x = village_center.x + village_size / 2;
@@ -202,18 +166,26 @@ std::vector<Plot> VillageGenerator::findPlots() {
     
     if (test_mode) {
         // --- TEST MODE: Deterministic Grid Scan & Sequential Size ---
-        // Uses a static variable to maintain sequential plot size across valid plots found during the scan
-        static int current_plot_size = MIN_PLOT_SIZE;
-
+        // next_plot_size keeps the sequential plot size across valid plots found during the scan.
+        // The terrain rules for each band of rows are evaluated in parallel as the scan reaches
+        // it; acceptance, which depends on the plots accepted so far, runs serially here.
+        // With a single scan thread nothing is speculated and each point is checked as reached.
+        const int STEP = 5;
+        int first_x = village_min_x + STEP, last_x = village_max_x - STEP;
+        int first_z = village_min_z + STEP, last_z = village_max_z - STEP;
+        GridSpeculation speculation(first_x, first_z, last_x, last_z, STEP, MIN_PLOT_SIZE, MAX_PLOT_SIZE);
+        
         // Iterate through the grid in 5 block increments
-        for (int z = village_min_z + 5; z <= village_max_z - 5; z += 5) {
-            for (int x = village_min_x + 5; x <= village_max_x - 5; x += 5) {
+        for (int z = first_z; z <= last_z; z += STEP) {
+            int row = (z - first_z) / STEP;
+            bool speculated = speculateGridRows(speculation, row);
+            for (int x = first_x; x <= last_x; x += STEP) {
                 
                 center_x = x;
                 center_z = z;
 
                 // Determine plot size sequentially (14-20, wrapping)
-                plot_size = current_plot_size;
+                plot_size = next_plot_size;
 
                 int origin_x = center_x - plot_size / 2;
                 int origin_z = center_z - plot_size / 2;
@@ -224,19 +196,19 @@ std::vector<Plot> VillageGenerator::findPlots() {
                 mcpp::Coordinate highest = getHighestBlock(center_x, center_z);
                 int height = highest.y;
                 
-                Plot candidate(
-                    mcpp::Coordinate(origin_x, height, origin_z),
-                    mcpp::Coordinate(bound_x, height, bound_z),
-                    mcpp::Coordinate(0, height, 0),
-                    height
-                );
+                Plot candidate(origin_x, origin_z, bound_x, bound_z, height);
 
-                if (isValidPlot(candidate, plots)) {
+                bool terrain_ok = speculated
+                    ? speculation.fitsAt(row, (x - first_x) / STEP, plot_size)
+                    : checkTerrainRules(candidate);
+                
+                if (terrain_ok && checkPlotIntersection(candidate, plots) && checkVillageBounds(candidate)) {
                     // Update sequential size for the next valid plot
-                    current_plot_size = (current_plot_size == MAX_PLOT_SIZE) ? MIN_PLOT_SIZE : current_plot_size + 1;
+                    next_plot_size = (next_plot_size == MAX_PLOT_SIZE) ? MIN_PLOT_SIZE : next_plot_size + 1;
                     
-                    candidate.entrance = selectEntrance(candidate);
+                    candidate.setEntrance(selectEntrance(candidate));
                     plots.push_back(candidate);
+                    on_accept(plots[plots.size() - 1]);
                 }
 
                 // Stop after 100 plots (general upper limit)
@@ -267,16 +239,12 @@ std::vector<Plot> VillageGenerator::findPlots() {
             mcpp::Coordinate highest = getHighestBlock(center_x, center_z);
             int height = highest.y;
             
-            Plot candidate(
-                mcpp::Coordinate(origin_x, height, origin_z),
-                mcpp::Coordinate(bound_x, height, bound_z),
-                mcpp::Coordinate(0, height, 0),
-                height
-            );
+            Plot candidate(origin_x, origin_z, bound_x, bound_z, height);
             
             if (isValidPlot(candidate, plots)) {
-                candidate.entrance = selectEntrance(candidate);
+                candidate.setEntrance(selectEntrance(candidate));
                 plots.push_back(candidate);
+                on_accept(plots[plots.size() - 1]);
             }
             
             attempts++;
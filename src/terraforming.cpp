@@ -1,4 +1,5 @@
 #include "village_generator.h"
+#include <algorithm>
 #include <cmath>
 
 /**
@@ -6,97 +7,90 @@
  * Formula: block_height(d, yg, yp, p) = round(yg + (yp - yg) * (p - d) / p)
  * where d is distance from plot edge, yg is ground height, yp is plot height, p is plot_border
  */
-void VillageGenerator::terraformPlots(const std::vector<Plot>& plots) {
+void VillageGenerator::terraformPlots(const PlotSet& plots) {
     for (const auto& plot : plots) {
-        int plot_height = plot.height;
-        
-        // Terraform the border area around each plot
-        int border_min_x = plot.origin.x - plot_border;
-        int border_max_x = plot.bound.x + plot_border;
-        int border_min_z = plot.origin.z - plot_border;
-        int border_max_z = plot.bound.z + plot_border;
-        
-        for (int x = border_min_x; x <= border_max_x; x++) {
-            for (int z = border_min_z; z <= border_max_z; z++) {
-                // Skip if inside the plot itself
-                if (x >= plot.origin.x && x <= plot.bound.x &&
-                    z >= plot.origin.z && z <= plot.bound.z) {
-                    continue;
-                }
-                
-                // Calculate distance to nearest plot edge
-                int dist_x = 0;
-                if (x < plot.origin.x) {
-                    dist_x = plot.origin.x - x;
-                } else if (x > plot.bound.x) {
-                    dist_x = x - plot.bound.x;
-                }
-                
-                int dist_z = 0;
-                if (z < plot.origin.z) {
-                    dist_z = plot.origin.z - z;
-                } else if (z > plot.bound.z) {
-                    dist_z = z - plot.bound.z;
-                }
+        terraformPlot(plot);
+    }
+    
+    writer.flush();
+}
+
+/**
+ * Terraform the border of one plot and flatten the plot itself
+ */
+void VillageGenerator::terraformPlot(const Plot& plot) {
+    int plot_height = plot.height();
+    
+    // Terraform the border area around each plot
+    int border_min_x = plot.minX() - plot_border;
+    int border_max_x = plot.maxX() + plot_border;
+    int border_min_z = plot.minZ() - plot_border;
+    int border_max_z = plot.maxZ() + plot_border;
+    
+    for (int x = border_min_x; x <= border_max_x; x++) {
+        for (int z = border_min_z; z <= border_max_z; z++) {
+            // Skip if inside the plot itself
+            if (x >= plot.minX() && x <= plot.maxX() &&
+                z >= plot.minZ() && z <= plot.maxZ()) {
+                continue;
+            }
+            
+            // Calculate distance to nearest plot edge
+            int dist_x = 0;
+            if (x < plot.minX()) {
+                dist_x = plot.minX() - x;
+            } else if (x > plot.maxX()) {
+                dist_x = x - plot.maxX();
+            }
+            
+            int dist_z = 0;
+            if (z < plot.minZ()) {
+                dist_z = plot.minZ() - z;
+            } else if (z > plot.maxZ()) {
+                dist_z = z - plot.maxZ();
+            }
+            
+            int distance = std::max(dist_x, dist_z);
+            
+            if (distance > 0 && distance <= plot_border) {
+                // Get current ground height
+                int ground_height = borderHeight(x, z);
                 
-                int distance = std::max(dist_x, dist_z);
+                // Linear interpolation: closer to plot = more influence from plot height
+                double factor = (double)(plot_border - distance) / plot_border;
+                int target_height = (int)std::round(ground_height + 
+                                    (plot_height - ground_height) * factor);
                 
-                if (distance > 0 && distance <= plot_border) {
-                    // Get current ground height
-                    mcpp::Coordinate highest = mcpp::Coordinate(x, 255, z);
-                    for (int y = 255; y >= 0; y--) {
-                        mcpp::Block block = mcpp::getBlock(mcpp::Coordinate(x, y, z));
-                        if (block.id != 0) {
-                            highest.y = y;
-                            break;
-                        }
+                // Modify terrain to target height
+                if (target_height > ground_height) {
+                    // Fill up
+                    for (int y = ground_height + 1; y <= target_height; y++) {
+                        placeBlock(mcpp::Coordinate(x, y, z), 3); // Dirt
                     }
-                    
-                    int ground_height = highest.y;
-                    
-                    // Linear interpolation: closer to plot = more influence from plot height
-                    double factor = (double)(plot_border - distance) / plot_border;
-                    int target_height = (int)std::round(ground_height + 
-                                        (plot_height - ground_height) * factor);
-                    
-                    // Modify terrain to target height
-                    if (target_height > ground_height) {
-                        // Fill up
-                        for (int y = ground_height + 1; y <= target_height; y++) {
-                            mcpp::setBlock(mcpp::Coordinate(x, y, z), mcpp::Block(3)); // Dirt
-                        }
-                    } else if (target_height < ground_height) {
-                        // Remove blocks
-                        for (int y = ground_height; y > target_height; y--) {
-                            mcpp::setBlock(mcpp::Coordinate(x, y, z), mcpp::Block(0)); // Air
-                        }
+                } else if (target_height < ground_height) {
+                    // Remove blocks
+                    for (int y = ground_height; y > target_height; y--) {
+                        placeBlock(mcpp::Coordinate(x, y, z), 0); // Air
                     }
                 }
             }
         }
-        
-        // Flatten the plot itself
-        for (int x = plot.origin.x; x <= plot.bound.x; x++) {
-            for (int z = plot.origin.z; z <= plot.bound.z; z++) {
-                // Remove everything above plot height
-                for (int y = plot_height + 1; y <= 255; y++) {
-                    mcpp::setBlock(mcpp::Coordinate(x, y, z), mcpp::Block(0)); // Air
-                }
-                
-                // Fill up to plot height if needed
-                mcpp::Coordinate highest = mcpp::Coordinate(x, 0, z);
-                for (int y = 255; y >= 0; y--) {
-                    mcpp::Block block = mcpp::getBlock(mcpp::Coordinate(x, y, z));
-                    if (block.id != 0) {
-                        highest.y = y;
-                        break;
-                    }
-                }
-                
-                if (highest.y < plot_height) {
-                    for (int y = highest.y + 1; y <= plot_height; y++) {
-                        mcpp::setBlock(mcpp::Coordinate(x, y, z), mcpp::Block(3)); // Dirt
-                    }
+    }
+    
+    // Flatten the plot itself
+    for (int x = plot.minX(); x <= plot.maxX(); x++) {
+        for (int z = plot.minZ(); z <= plot.maxZ(); z++) {
+            // Remove everything above plot height
+            for (int y = plot_height + 1; y <= 255; y++) {
+                placeBlock(mcpp::Coordinate(x, y, z), 0); // Air
+            }
+            
+            // Fill up to plot height if needed
+            mcpp::Coordinate highest(x, std::max(0, worldHeight(x, z)), z);
+            
+            if (highest.y < plot_height) {
+                for (int y = highest.y + 1; y <= plot_height; y++) {
+                    placeBlock(mcpp::Coordinate(x, y, z), 3); // Dirt
                 }
             }
         }
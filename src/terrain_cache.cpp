@@ -0,0 +1,121 @@
+#include "village_generator.h"
+
+/**
+ * Read the full column at (x, z) into the terrain cache, from the world
+ * source's region files if set (loading the whole chunk) or else from the
+ * world backend. Called with terrain_mutex held.
+ */
+void VillageGenerator::loadColumn(int x, int z) {
+    if (world_source) {
+        world_source->loadChunk(x >> 4, z >> 4, terrain);
+        return;
+    }
+    BlockId column[VoxelRegion::WORLD_HEIGHT];
+    {
+        std::lock_guard<std::mutex> io(io_mutex);
+        for (int y = 0; y < VoxelRegion::WORLD_HEIGHT; y++) {
+            column[y] = backend->getBlock(x, y, z);
+        }
+    }
+    terrain.storeColumn(x, z, column);
+}
+
+size_t VillageGenerator::preloadTerrain() {
+    if (!world_source) {
+        return 0;
+    }
+    int halo = village_size / 2 + plot_border;
+    std::lock_guard<std::mutex> lock(terrain_mutex);
+    return world_source->loadArea(village_center.x - halo, village_center.z - halo,
+                                  village_center.x + halo, village_center.z + halo, terrain);
+}
+
+/**
+ * Height of the highest non-air block at (x, z) in the unedited terrain,
+ * or -1 for an empty column
+ */
+int VillageGenerator::terrainHeight(int x, int z) {
+    std::lock_guard<std::mutex> lock(terrain_mutex);
+    if (!terrain.isColumnLoaded(x, z)) {
+        loadColumn(x, z);
+    }
+    return terrain.highestNonAir(x, z);
+}
+
+/**
+ * Block at (x, y, z) in the unedited terrain
+ */
+BlockId VillageGenerator::terrainBlock(int x, int y, int z) {
+    std::lock_guard<std::mutex> lock(terrain_mutex);
+    if (!terrain.isColumnLoaded(x, z)) {
+        loadColumn(x, z);
+    }
+    return terrain.getBlock(x, y, z);
+}
+
+/**
+ * Get the highest non-air block at coordinates (x, z) in the unedited terrain
+ */
+mcpp::Coordinate VillageGenerator::getHighestBlock(int x, int z) {
+    int y = terrainHeight(x, z);
+    return mcpp::Coordinate(x, y >= 0 ? y : 0, z);
+}
+
+/**
+ * Height of the highest non-air block at (x, z) including every edit made so
+ * far, or -1 for an empty column
+ */
+int VillageGenerator::worldHeight(int x, int z) {
+    {
+        std::lock_guard<std::mutex> lock(edits_mutex);
+        if (edits.isColumnLoaded(x, z)) {
+            return edits.highestNonAir(x, z);
+        }
+    }
+    return terrainHeight(x, z);
+}
+
+/**
+ * Current ground height for terraforming a plot border. An empty column counts
+ * as 255, where a scan down from the build limit gives up.
+ */
+int VillageGenerator::borderHeight(int x, int z) {
+    int y = worldHeight(x, z);
+    return y >= 0 ? y : 255;
+}
+
+/**
+ * Block at (x, y, z) including every edit made so far
+ */
+BlockId VillageGenerator::worldBlock(int x, int y, int z) {
+    {
+        std::lock_guard<std::mutex> lock(edits_mutex);
+        if (edits.isColumnLoaded(x, z)) {
+            return edits.getBlock(x, y, z);
+        }
+    }
+    return terrainBlock(x, y, z);
+}
+
+/**
+ * Set a block on the server and record it in the edited terrain. The first
+ * edit to a column copies it from the unedited terrain.
+ */
+void VillageGenerator::placeBlock(const mcpp::Coordinate& pos, int block_id) {
+    {
+        std::lock_guard<std::mutex> lock(edits_mutex);
+        if (!edits.isColumnLoaded(pos.x, pos.z)) {
+            BlockId column[VoxelRegion::WORLD_HEIGHT];
+            {
+                std::lock_guard<std::mutex> read(terrain_mutex);
+                if (!terrain.isColumnLoaded(pos.x, pos.z)) {
+                    loadColumn(pos.x, pos.z);
+                }
+                terrain.decodeColumn(pos.x, pos.z, column);
+            }
+            edits.storeColumn(pos.x, pos.z, column);
+        }
+        edits.setBlock(pos.x, pos.y, pos.z, (BlockId)block_id);
+    }
+    writer.setBlock(pos, block_id);
+}
@@ -3,7 +3,7 @@
 /**
  * Build a 3-4 block high wall around the village perimeter
  */
-void VillageGenerator::buildWall(const std::vector<Plot>& plots) {
+void VillageGenerator::buildWall(const PlotSet& plots) {
     int village_min_x = village_center.x - village_size / 2;
     int village_max_x = village_center.x + village_size / 2;
     int village_min_z = village_center.z - village_size / 2;
@@ -18,24 +18,18 @@ void VillageGenerator::buildWall(const std::vector<Plot>& plots) {
     
     // Sample corners and edges
     for (int x = village_min_x; x <= village_max_x; x += 10) {
-        for (int y = 255; y >= 0; y--) {
-            mcpp::Block block = mcpp::getBlock(mcpp::Coordinate(x, y, village_min_z));
-            if (block.id != 0) {
-                avg_height += y;
-                count++;
-                break;
-            }
+        int y = worldHeight(x, village_min_z);
+        if (y >= 0) {
+            avg_height += y;
+            count++;
         }
     }
     
     for (int z = village_min_z; z <= village_max_z; z += 10) {
-        for (int y = 255; y >= 0; y--) {
-            mcpp::Block block = mcpp::getBlock(mcpp::Coordinate(village_max_x, y, z));
-            if (block.id != 0) {
-                avg_height += y;
-                count++;
-                break;
-            }
+        int y = worldHeight(village_max_x, z);
+        if (y >= 0) {
+            avg_height += y;
+            count++;
         }
     }
     
@@ -49,12 +43,12 @@ void VillageGenerator::buildWall(const std::vector<Plot>& plots) {
     for (int x = village_min_x; x <= village_max_x; x++) {
         // North wall
         for (int y = avg_height; y < avg_height + WALL_HEIGHT; y++) {
-            mcpp::setBlock(mcpp::Coordinate(x, y, village_min_z), mcpp::Block(WALL_BLOCK_ID));
+            placeBlock(mcpp::Coordinate(x, y, village_min_z), WALL_BLOCK_ID);
         }
         
         // South wall
         for (int y = avg_height; y < avg_height + WALL_HEIGHT; y++) {
-            mcpp::setBlock(mcpp::Coordinate(x, y, village_max_z), mcpp::Block(WALL_BLOCK_ID));
+            placeBlock(mcpp::Coordinate(x, y, village_max_z), WALL_BLOCK_ID);
         }
     }
     
@@ -62,12 +56,14 @@ void VillageGenerator::buildWall(const std::vector<Plot>& plots) {
     for (int z = village_min_z; z <= village_max_z; z++) {
         // West wall
         for (int y = avg_height; y < avg_height + WALL_HEIGHT; y++) {
-            mcpp::setBlock(mcpp::Coordinate(village_min_x, y, z), mcpp::Block(WALL_BLOCK_ID));
+            placeBlock(mcpp::Coordinate(village_min_x, y, z), WALL_BLOCK_ID);
         }
         
         // East wall
         for (int y = avg_height; y < avg_height + WALL_HEIGHT; y++) {
-            mcpp::setBlock(mcpp::Coordinate(village_max_x, y, z), mcpp::Block(WALL_BLOCK_ID));
+            placeBlock(mcpp::Coordinate(village_max_x, y, z), WALL_BLOCK_ID);
         }
     }
+    
+    writer.flush();
 }
@@ -6,7 +6,7 @@
  * Place waypoints for pathfinding between plots
  * Groups plots into 3's and finds center points suitable for waypoints
  */
-std::vector<mcpp::Coordinate> VillageGenerator::placeWaypoints(const std::vector<Plot>& plots) {
+std::vector<mcpp::Coordinate> VillageGenerator::placeWaypoints(const PlotSet& plots) {
     std::vector<mcpp::Coordinate> waypoints;
     
     if (plots.empty()) {
@@ -14,15 +14,17 @@ std::vector<mcpp::Coordinate> VillageGenerator::placeWaypoints(const std::vector
     }
     
     // Group plots into 3's, preferring groups with small total area
-    std::vector<std::vector<const Plot*>> groups;
-    std::vector<bool> used(plots.size(), false);
+    std::pmr::vector<std::pmr::vector<size_t>> groups(arena.resource());
+    std::pmr::vector<bool> used(plots.size(), false, arena.resource());
+    groups.reserve(plots.size() / 3 + 1);
     
     // Create groups of 3 plots with smallest total area
     for (size_t i = 0; i < plots.size(); i++) {
         if (used[i]) continue;
         
-        std::vector<const Plot*> group;
-        group.push_back(&plots[i]);
+        std::pmr::vector<size_t> group(arena.resource());
+        group.reserve(3);
+        group.push_back(i);
         used[i] = true;
         
         // Find 2 more closest plots
@@ -30,20 +32,21 @@ std::vector<mcpp::Coordinate> VillageGenerator::placeWaypoints(const std::vector
             double min_dist = 1e9;
             int best_idx = -1;
             
+            // Calculate group center once per pick
+            int group_center_x = 0, group_center_z = 0;
+            for (size_t idx : group) {
+                group_center_x += plots.centerX(idx);
+                group_center_z += plots.centerZ(idx);
+            }
+            group_center_x /= group.size();
+            group_center_z /= group.size();
+            
             for (size_t k = 0; k < plots.size(); k++) {
                 if (used[k]) continue;
                 
                 // Calculate distance from group center to this plot
-                int group_center_x = 0, group_center_z = 0;
-                for (const auto* p : group) {
-                    group_center_x += (p->origin.x + p->bound.x) / 2;
-                    group_center_z += (p->origin.z + p->bound.z) / 2;
-                }
-                group_center_x /= group.size();
-                group_center_z /= group.size();
-                
-                int plot_center_x = (plots[k].origin.x + plots[k].bound.x) / 2;
-                int plot_center_z = (plots[k].origin.z + plots[k].bound.z) / 2;
+                int plot_center_x = plots.centerX(k);
+                int plot_center_z = plots.centerZ(k);
                 
                 double dist = std::sqrt(
                     (group_center_x - plot_center_x) * (group_center_x - plot_center_x) +
@@ -57,45 +60,35 @@ std::vector<mcpp::Coordinate> VillageGenerator::placeWaypoints(const std::vector
             }
             
             if (best_idx != -1) {
-                group.push_back(&plots[best_idx]);
+                group.push_back(best_idx);
                 used[best_idx] = true;
             }
         }
         
-        groups.push_back(group);
+        groups.push_back(std::move(group));
     }
     
     // Find center point of each group
     for (const auto& group : groups) {
         int center_x = 0, center_z = 0;
         
-        for (const auto* plot : group) {
-            center_x += (plot->origin.x + plot->bound.x) / 2;
-            center_z += (plot->origin.z + plot->bound.z) / 2;
+        for (size_t idx : group) {
+            center_x += plots.centerX(idx);
+            center_z += plots.centerZ(idx);
         }
         
         center_x /= group.size();
         center_z /= group.size();
         
         // Check if center point is suitable (not inside any plot)
-        bool suitable = true;
-        for (const auto& plot : plots) {
-            if (center_x >= plot.origin.x && center_x <= plot.bound.x &&
-                center_z >= plot.origin.z && center_z <= plot.bound.z) {
-                suitable = false;
-                break;
-            }
-        }
+        bool suitable = !plots.containsAny(center_x, center_z);
         
         if (suitable) {
             // Get height at waypoint location
             mcpp::Coordinate highest = mcpp::Coordinate(center_x, 0, center_z);
-            for (int y = 255; y >= 0; y--) {
-                mcpp::Block block = mcpp::getBlock(mcpp::Coordinate(center_x, y, center_z));
-                if (block.id != 0) {
-                    highest.y = y + 1;
-                    break;
-                }
+            int ground = worldHeight(center_x, center_z);
+            if (ground >= 0) {
+                highest.y = ground + 1;
             }
             
             waypoints.push_back(highest);
@@ -0,0 +1,619 @@
+#include "village_generator.h"
+#include "reference_generator.h"
+#include "world_backend.h"
+#include "chunk_section.h"
+#include "anvil_reader.h"
+#include <sys/stat.h>
+#include <zlib.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+/**
+ * Differential harness: runs the reference generator and each optimised
+ * engine against identical in-memory worlds and compares the plots,
+ * waypoints and final block state. Exits non-zero on any difference.
+ */
+
+typedef void (*TerrainFn)(int x, int z, uint32_t seed, BlockId* column);
+
+static uint32_t hash(uint32_t seed, int x, int z) {
+    uint32_t h = seed * 0x9E3779B1u ^ (uint32_t)x * 0x85EBCA77u ^ (uint32_t)z * 0xC2B2AE3Du;
+    h ^= h >> 15;
+    h *= 0x2C1B3C6Du;
+    h ^= h >> 12;
+    return h;
+}
+
+/**
+ * Stone up to height - 3, dirt above, then grass on dry land or water up to sea_level
+ */
+static void fillColumn(BlockId* column, int height, int sea_level) {
+    for (int y = 0; y <= height && y < VoxelRegion::WORLD_HEIGHT; y++) {
+        column[y] = y == 0 ? 7 : (y < height - 3 ? 1 : 3);
+    }
+    if (height < sea_level) {
+        for (int y = height + 1; y <= sea_level; y++) column[y] = 9;
+    } else {
+        column[height] = 2;
+    }
+}
+
+// Rolling hills with the odd tree (same shape as the mock server)
+static void hillsTerrain(int x, int z, uint32_t seed, BlockId* column) {
+    double phase = (seed % 1000) * 0.1;
+    int height = (int)std::floor(64 + 7 * std::sin(x * 0.031 + phase) + 5 * std::cos(z * 0.043 - phase) +
+                                 3 * std::sin((x + z) * 0.11));
+    fillColumn(column, height, 62);
+    if (height >= 62 && hash(seed, x, z) % 97 == 0) {
+        for (int y = height + 1; y <= height + 4; y++) column[y] = 17;
+        column[height + 5] = 18;
+    }
+}
+
+// Short waves with single water and leaf blocks scattered over the surface
+static void ripplesTerrain(int x, int z, uint32_t seed, BlockId* column) {
+    int height = 64 + (int)(6 * std::sin(x * 0.05 + seed) + 5 * std::cos(z * 0.07 - seed));
+    fillColumn(column, height, 0);
+    uint32_t h = hash(seed, x, z);
+    if (h % 64 == 0) column[height] = 9;
+    else if (h % 128 == 1) column[height] = 18;
+}
+
+// Steep ridges that fail the slope rule over much of the area
+static void mountainsTerrain(int x, int z, uint32_t seed, BlockId* column) {
+    double phase = (seed % 100) * 0.37;
+    int height = (int)std::floor(90 + 30 * std::sin(x * 0.045 + phase) * std::cos(z * 0.038 - phase) +
+                                 4 * std::sin((x - z) * 0.2));
+    fillColumn(column, height, 62);
+}
+
+// Low ground broken up by lakes
+static void lakesTerrain(int x, int z, uint32_t seed, BlockId* column) {
+    double phase = (seed % 1000) * 0.05;
+    int height = (int)std::floor(62 + 5 * std::sin(x * 0.021 + phase) + 5 * std::cos(z * 0.027 + phase));
+    fillColumn(column, height, 62);
+}
+
+// Open sea with small islands, where plot finding usually comes up short
+static void islandsTerrain(int x, int z, uint32_t seed, BlockId* column) {
+    double phase = (seed % 1000) * 0.3;
+    int height = (int)std::floor(54 + 10 * std::sin(x * 0.06 + phase) * std::sin(z * 0.06 - phase));
+    fillColumn(column, height, 62);
+}
+
+// Hills with scattered columns open to the void
+static void voidTerrain(int x, int z, uint32_t seed, BlockId* column) {
+    if (hash(seed + 7, x, z) % 97 == 0) {
+        return;
+    }
+    hillsTerrain(x, z, seed, column);
+}
+
+struct Terrain {
+    const char* name;
+    TerrainFn fill;
+};
+
+static const Terrain TERRAINS[] = {
+    {"hills", hillsTerrain}, {"ripples", ripplesTerrain}, {"mountains", mountainsTerrain},
+    {"lakes", lakesTerrain}, {"islands", islandsTerrain}, {"void", voidTerrain},
+};
+
+/**
+ * World backend holding procedural terrain plus every edit in memory. With a
+ * write latency, each write costs that much server time, slept off by the
+ * caller in steps of about a millisecond, as for a server that applies edits
+ * one at a time while terrain is read from region files.
+ */
+class MemoryWorld : public WorldBackend {
+public:
+    MemoryWorld(TerrainFn f, uint32_t s, double write_latency = 0)
+        : fill(f), seed(s), reads(0), writes(0), write_latency_us(write_latency), owed_us(0) {}
+
+    BlockId getBlock(int x, int y, int z) override {
+        reads++;
+        return peek(x, y, z);
+    }
+
+    void setBlock(int x, int y, int z, BlockId id) override {
+        writes++;
+        if (write_latency_us > 0) {
+            owed_us += write_latency_us;
+            if (owed_us >= 1000) {
+                // Pay off what was actually slept, so oversleeping is not charged twice
+                auto start = std::chrono::steady_clock::now();
+                std::this_thread::sleep_for(std::chrono::duration<double, std::micro>(owed_us));
+                owed_us -= std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+            }
+        }
+        if (y < 0 || y >= VoxelRegion::WORLD_HEIGHT) {
+            return;
+        }
+        ensureColumn(x, z);
+        region.setBlock(x, y, z, id);
+        written.insert(columnKey(x, z));
+    }
+
+    /**
+     * Block at (x, y, z) without counting a read
+     */
+    BlockId peek(int x, int y, int z) {
+        if (y < 0 || y >= VoxelRegion::WORLD_HEIGHT) {
+            return 0;
+        }
+        ensureColumn(x, z);
+        return region.getBlock(x, y, z);
+    }
+
+    const std::unordered_set<int64_t>& writtenColumns() const { return written; }
+    const std::set<std::pair<int, int>>& touchedChunks() const { return touched; }
+    size_t readCount() const { return reads; }
+    size_t writeCount() const { return writes; }
+
+    static int64_t columnKey(int x, int z) { return ((int64_t)x << 32) ^ (uint32_t)z; }
+    static int keyX(int64_t key) { return (int)(key >> 32); }
+    static int keyZ(int64_t key) { return (int32_t)(uint32_t)key; }
+
+private:
+    TerrainFn fill;
+    uint32_t seed;
+    VoxelRegion region;
+    std::unordered_set<int64_t> written;
+    std::set<std::pair<int, int>> touched;   // chunks of every column read or written
+    size_t reads;
+    size_t writes;
+    double write_latency_us;
+    double owed_us;
+
+    void ensureColumn(int x, int z) {
+        if (region.isColumnLoaded(x, z)) {
+            return;
+        }
+        BlockId column[VoxelRegion::WORLD_HEIGHT] = {0};
+        fill(x, z, seed, column);
+        region.storeColumn(x, z, column);
+        touched.insert(std::make_pair(x >> 4, z >> 4));
+    }
+};
+
+// Big-endian NBT writers for the region files below
+static void putInt(std::string& out, uint32_t v) {
+    for (int s = 24; s >= 0; s -= 8) out += (char)(v >> s);
+}
+
+static void putName(std::string& out, uint8_t type, const std::string& name) {
+    out += (char)type;
+    out += (char)(name.size() >> 8);
+    out += (char)name.size();
+    out += name;
+}
+
+static int floorDiv(int a, int b) {
+    return a >= 0 ? a / b : -((-a + b - 1) / b);
+}
+
+/**
+ * A temporary world folder whose region files hold the unedited procedural
+ * terrain of the given chunks, stored as pre-1.13 numeric block IDs so every
+ * block reads back exactly. Chunks left out load as air. Removed on destruction.
+ */
+class RegionFiles {
+public:
+    RegionFiles(TerrainFn fill, uint32_t seed, const std::set<std::pair<int, int>>& chunks) {
+        char dir[] = "/tmp/diff_harnessXXXXXX";
+        if (!mkdtemp(dir)) {
+            throw std::runtime_error("Could not create a temporary world folder");
+        }
+        path = dir;
+        if (mkdir((path + "/region").c_str(), 0755) != 0) {
+            throw std::runtime_error("Could not create " + path + "/region");
+        }
+        std::map<std::pair<int, int>, std::vector<std::pair<int, int>>> regions;
+        for (const auto& chunk : chunks) {
+            regions[std::make_pair(floorDiv(chunk.first, 32), floorDiv(chunk.second, 32))].push_back(chunk);
+        }
+        for (const auto& region : regions) {
+            writeRegion(fill, seed, region.first.first, region.first.second, region.second);
+        }
+    }
+
+    ~RegionFiles() {
+        std::system(("rm -rf " + path).c_str());
+    }
+
+    RegionFiles(const RegionFiles&) = delete;
+    RegionFiles& operator=(const RegionFiles&) = delete;
+
+    const std::string& worldDir() const { return path; }
+
+private:
+    std::string path;
+
+    void writeRegion(TerrainFn fill, uint32_t seed, int rx, int rz, const std::vector<std::pair<int, int>>& chunks) {
+        std::string region(8192, '\0');
+        for (const auto& chunk : chunks) {
+            int cx = chunk.first, cz = chunk.second;
+            std::string nbt = chunkNbt(fill, seed, cx, cz);
+            uLongf packed_size = compressBound(nbt.size());
+            std::vector<uint8_t> packed(packed_size);
+            if (compress2(packed.data(), &packed_size, (const Bytef*)nbt.data(), nbt.size(),
+                          Z_BEST_SPEED) != Z_OK) {
+                throw std::runtime_error("Could not compress chunk data");
+            }
+            
+            size_t sector = region.size() / 4096;
+            size_t sectors = (packed_size + 5 + 4095) / 4096;
+            int slot = 4 * ((cx & 31) + 32 * (cz & 31));
+            region[slot] = (char)(sector >> 16);
+            region[slot + 1] = (char)(sector >> 8);
+            region[slot + 2] = (char)sector;
+            region[slot + 3] = (char)sectors;
+            putInt(region, packed_size + 1);
+            region += (char)2;   // zlib
+            region.append((const char*)packed.data(), packed_size);
+            region.resize((sector + sectors) * 4096, '\0');
+        }
+        std::string file = path + "/region/r." + std::to_string(rx) + "." + std::to_string(rz) + ".mca";
+        std::ofstream out(file, std::ios::binary);
+        out << region;
+        if (!out) {
+            throw std::runtime_error("Could not write " + file);
+        }
+    }
+
+    // Level compound with one section per 16 blocks of height holding any non-air
+    static std::string chunkNbt(TerrainFn fill, uint32_t seed, int cx, int cz) {
+        std::vector<BlockId> columns((size_t)16 * 16 * VoxelRegion::WORLD_HEIGHT, 0);
+        for (int z = 0; z < 16; z++) {
+            for (int x = 0; x < 16; x++) {
+                fill(cx * 16 + x, cz * 16 + z, seed, &columns[(size_t)(z * 16 + x) * VoxelRegion::WORLD_HEIGHT]);
+            }
+        }
+        std::vector<std::string> sections;
+        for (int sy = 0; sy < VoxelRegion::WORLD_HEIGHT / 16; sy++) {
+            std::string blocks(ChunkSection::VOLUME, '\0');
+            bool any = false;
+            for (int i = 0; i < ChunkSection::VOLUME; i++) {
+                // Legacy arrays are ordered y, z, x
+                BlockId id = columns[(size_t)((i >> 4 & 15) * 16 + (i & 15)) * VoxelRegion::WORLD_HEIGHT +
+                                     sy * 16 + (i >> 8)];
+                blocks[i] = (char)id;
+                any = any || id != 0;
+            }
+            if (any) {
+                std::string section;
+                putName(section, 1, "Y");
+                section += (char)sy;
+                putName(section, 7, "Blocks");
+                putInt(section, ChunkSection::VOLUME);
+                section += blocks;
+                section += (char)0;
+                sections.push_back(section);
+            }
+        }
+        
+        std::string nbt;
+        putName(nbt, 10, "");
+        putName(nbt, 10, "Level");
+        putName(nbt, 3, "xPos");
+        putInt(nbt, cx);
+        putName(nbt, 3, "zPos");
+        putInt(nbt, cz);
+        putName(nbt, 9, "Sections");
+        nbt += (char)10;
+        putInt(nbt, sections.size());
+        for (const std::string& section : sections) nbt += section;
+        nbt += (char)0;   // end Level
+        nbt += (char)0;   // end root
+        return nbt;
+    }
+};
+
+struct HarnessCase {
+    const Terrain* terrain;
+    int seed;
+    bool test_mode;
+    int village_size;
+    int plot_border;
+    std::string world_dir;   // region files of the unedited terrain the reference touched
+};
+
+/**
+ * How runGenerator drives the current VillageGenerator. Engines pin the
+ * scan thread count so each run exercises the same scan on any machine.
+ */
+struct EngineConfig {
+    bool pipelined;             // runPipelined instead of the sequential stages
+    bool chunk_ordered;         // hold writes until the end of the run
+    unsigned scan_threads;      // test-mode grid scan threads
+    double target_latency_ms;   // write flow control target; 0 sends each block at once
+    bool region_reads;          // read terrain from the case's region files
+};
+
+/**
+ * What one engine produced for one case
+ */
+struct RunResult {
+    std::vector<Plot> plots;
+    std::vector<mcpp::Coordinate> waypoints;
+    std::string error;
+    double ms;
+};
+
+static double elapsedMs(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+static RunResult runReference(MemoryWorld& world, const HarnessCase& c) {
+    RunResult result;
+    auto start = std::chrono::steady_clock::now();
+    ReferenceGenerator generator(world, mcpp::Coordinate(0, 0, 0), c.village_size, c.plot_border,
+                                 c.seed, c.test_mode);
+    try {
+        result.plots = generator.findPlots();
+        generator.terraformPlots(result.plots);
+        generator.buildWall(result.plots);
+        result.waypoints = generator.placeWaypoints(result.plots);
+    } catch (const std::exception& e) {
+        result.error = e.what();
+    }
+    result.ms = elapsedMs(start);
+    return result;
+}
+
+/**
+ * Run the current VillageGenerator as configured, writing to world and
+ * reading from it or from the case's region files
+ */
+static RunResult runGenerator(MemoryWorld& world, const HarnessCase& c, const EngineConfig& config) {
+    RunResult result;
+    auto start = std::chrono::steady_clock::now();
+    std::unique_ptr<AnvilWorld> region;
+    if (config.region_reads) {
+        region.reset(new AnvilWorld(c.world_dir));
+    }
+    VillageGenerator generator(mcpp::Coordinate(0, 0, 0), c.village_size, c.plot_border, c.seed, c.test_mode);
+    generator.setWorldBackend(&world);
+    generator.setWorldSource(region.get());
+    generator.setChunkOrderedWrites(config.chunk_ordered);
+    generator.setScanThreads(config.scan_threads);
+    generator.setTargetLatency(config.target_latency_ms);
+    PlotSet plots;
+    try {
+        generator.preloadTerrain();
+        if (config.pipelined) {
+            generator.runPipelined(plots, result.waypoints);
+        } else {
+            plots = generator.findPlots();
+            generator.terraformPlots(plots);
+            generator.buildWall(plots);
+            result.waypoints = generator.placeWaypoints(plots);
+        }
+        generator.commitWrites();
+    } catch (const std::exception& e) {
+        result.error = e.what();
+    }
+    result.ms = elapsedMs(start);
+    for (const Plot& plot : plots) {
+        result.plots.push_back(plot);
+    }
+    return result;
+}
+
+static std::string describe(const Plot& p) {
+    std::ostringstream out;
+    out << "(" << p.minX() << "," << p.minZ() << ")-(" << p.maxX() << "," << p.maxZ()
+        << ") y=" << p.height() << " entrance (" << p.entrance().x << "," << p.entrance().z << ")";
+    return out.str();
+}
+
+/**
+ * Compare an engine's result and world against the reference; returns the
+ * number of differences and prints the first few
+ */
+static size_t compareRuns(const RunResult& ref, MemoryWorld& ref_world,
+                          const RunResult& got, MemoryWorld& got_world) {
+    size_t differences = 0;
+    const size_t SHOW = 3;
+    auto report = [&](const std::string& what) {
+        if (differences++ < SHOW) std::cout << "      " << what << std::endl;
+    };
+
+    if (ref.error != got.error) {
+        report("error: expected \"" + ref.error + "\", got \"" + got.error + "\"");
+    }
+
+    if (ref.plots.size() != got.plots.size()) {
+        report("plot count: expected " + std::to_string(ref.plots.size()) + ", got " +
+               std::to_string(got.plots.size()));
+    }
+    for (size_t i = 0; i < ref.plots.size() && i < got.plots.size(); i++) {
+        const Plot& a = ref.plots[i];
+        const Plot& b = got.plots[i];
+        if (a.minX() != b.minX() || a.minZ() != b.minZ() || a.maxX() != b.maxX() || a.maxZ() != b.maxZ() ||
+            a.height() != b.height() || a.entrance().x != b.entrance().x || a.entrance().z != b.entrance().z) {
+            report("plot " + std::to_string(i) + ": expected " + describe(a) + ", got " + describe(b));
+        }
+    }
+
+    if (ref.waypoints.size() != got.waypoints.size()) {
+        report("waypoint count: expected " + std::to_string(ref.waypoints.size()) + ", got " +
+               std::to_string(got.waypoints.size()));
+    }
+    for (size_t i = 0; i < ref.waypoints.size() && i < got.waypoints.size(); i++) {
+        const mcpp::Coordinate& a = ref.waypoints[i];
+        const mcpp::Coordinate& b = got.waypoints[i];
+        if (a.x != b.x || a.y != b.y || a.z != b.z) {
+            std::ostringstream out;
+            out << "waypoint " << i << ": expected (" << a.x << "," << a.y << "," << a.z
+                << "), got (" << b.x << "," << b.y << "," << b.z << ")";
+            report(out.str());
+        }
+    }
+
+    // Every column either engine wrote must end up block for block the same
+    std::unordered_set<int64_t> columns = ref_world.writtenColumns();
+    columns.insert(got_world.writtenColumns().begin(), got_world.writtenColumns().end());
+    for (int64_t key : columns) {
+        int x = MemoryWorld::keyX(key);
+        int z = MemoryWorld::keyZ(key);
+        for (int y = 0; y < VoxelRegion::WORLD_HEIGHT; y++) {
+            BlockId a = ref_world.peek(x, y, z);
+            BlockId b = got_world.peek(x, y, z);
+            if (a != b) {
+                std::ostringstream out;
+                out << "block (" << x << "," << y << "," << z << "): expected " << a << ", got " << b;
+                report(out.str());
+            }
+        }
+    }
+
+    if (differences > SHOW) {
+        std::cout << "      ... " << differences - SHOW << " more" << std::endl;
+    }
+    return differences;
+}
+
+struct HarnessOptions {
+    std::vector<int> seeds = {1, 2};
+    std::vector<std::string> terrains;
+    std::vector<bool> modes = {true, false};
+    int village_size = 120;
+    int plot_border = 10;
+    double write_latency_us = 0;
+};
+
+static std::vector<std::string> splitList(const std::string& list) {
+    std::vector<std::string> items;
+    std::stringstream ss(list);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        if (!item.empty()) items.push_back(item);
+    }
+    return items;
+}
+
+static bool parseOptions(int argc, char* argv[], HarnessOptions& opts) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg.substr(0, 8) == "--seeds=") {
+            opts.seeds.clear();
+            for (const std::string& s : splitList(arg.substr(8))) opts.seeds.push_back(std::stoi(s));
+        } else if (arg.substr(0, 11) == "--terrains=") {
+            opts.terrains = splitList(arg.substr(11));
+        } else if (arg.substr(0, 8) == "--modes=") {
+            opts.modes.clear();
+            for (const std::string& m : splitList(arg.substr(8))) {
+                if (m != "test" && m != "random") {
+                    std::cerr << "Error: Unknown mode " << m << std::endl;
+                    return false;
+                }
+                opts.modes.push_back(m == "test");
+            }
+        } else if (arg.substr(0, 15) == "--village-size=") {
+            opts.village_size = std::stoi(arg.substr(15));
+        } else if (arg.substr(0, 14) == "--plot-border=") {
+            opts.plot_border = std::stoi(arg.substr(14));
+        } else if (arg.substr(0, 19) == "--write-latency-us=") {
+            opts.write_latency_us = std::stod(arg.substr(19));
+        } else {
+            std::cerr << "Error: Unknown option " << arg << std::endl;
+            return false;
+        }
+    }
+    if (opts.village_size <= 0 || opts.plot_border < 0 || opts.write_latency_us < 0) {
+        std::cerr << "Error: village-size must be positive, plot-border and write-latency-us non-negative"
+                  << std::endl;
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    HarnessOptions opts;
+    if (!parseOptions(argc, argv, opts)) {
+        return 1;
+    }
+
+    std::vector<const Terrain*> terrains;
+    for (const Terrain& t : TERRAINS) {
+        bool wanted = opts.terrains.empty();
+        for (const std::string& name : opts.terrains) wanted = wanted || name == t.name;
+        if (wanted) terrains.push_back(&t);
+    }
+    if (terrains.empty()) {
+        std::cerr << "Error: No known terrain selected" << std::endl;
+        return 1;
+    }
+
+    const std::vector<std::pair<std::string, EngineConfig>> engines = {
+        {"cached", {false, false, 1, 0, false}},
+        {"pipelined", {true, false, 2, 0, false}},
+        {"chunk-ordered", {false, true, 2, 0, false}},
+        {"parallel-scan", {false, false, 4, 0, false}},
+        {"flow-controlled", {false, false, 1, 0.01, false}},
+        {"region-file", {false, false, 1, 0, true}},
+        {"region-pipelined", {true, false, 2, 0, true}},
+    };
+
+    std::cout << "=== Differential Harness ===" << std::endl;
+    std::cout << std::fixed << std::setprecision(1);
+    size_t runs = 0, failed = 0;
+    std::vector<double> ref_total(engines.size(), 0), engine_total(engines.size(), 0);
+
+    for (const Terrain* terrain : terrains) {
+        for (int seed : opts.seeds) {
+            for (bool test_mode : opts.modes) {
+                HarnessCase c{terrain, seed, test_mode, opts.village_size, opts.plot_border, ""};
+                MemoryWorld ref_world(terrain->fill, seed, opts.write_latency_us);
+                RunResult ref = runReference(ref_world, c);
+                RegionFiles regions(terrain->fill, seed, ref_world.touchedChunks());
+                c.world_dir = regions.worldDir();
+                std::cout << terrain->name << " seed=" << seed << (test_mode ? " test" : " random")
+                          << ": reference " << ref.plots.size() << " plots, " << ref.waypoints.size()
+                          << " waypoints, " << ref_world.readCount() << " reads, "
+                          << ref_world.writeCount() << " writes, " << ref.ms << " ms"
+                          << (ref.error.empty() ? "" : " (" + ref.error + ")") << std::endl;
+
+                for (size_t e = 0; e < engines.size(); e++) {
+                    MemoryWorld world(terrain->fill, seed, opts.write_latency_us);
+                    RunResult got = runGenerator(world, c, engines[e].second);
+                    size_t differences = compareRuns(ref, ref_world, got, world);
+                    runs++;
+                    if (differences) failed++;
+                    ref_total[e] += ref.ms;
+                    engine_total[e] += got.ms;
+                    std::cout << "  " << (differences ? "[DIFF] " : "[SAME] ") << std::left
+                              << std::setw(18) << engines[e].first << std::right << world.readCount()
+                              << " reads, " << world.writeCount() << " writes, " << got.ms << " ms, "
+                              << (got.ms > 0 ? ref.ms / got.ms : 0) << "x";
+                    if (differences) std::cout << ", " << differences << " differences";
+                    std::cout << std::endl;
+                }
+            }
+        }
+    }
+
+    std::cout << "\n=== Harness Results ===" << std::endl;
+    for (size_t e = 0; e < engines.size(); e++) {
+        std::cout << engines[e].first << ": " << (engine_total[e] > 0 ? ref_total[e] / engine_total[e] : 0)
+                  << "x reference throughput" << std::endl;
+    }
+    std::cout << "Identical: " << runs - failed << " of " << runs << std::endl;
+    return failed ? 1 : 0;
+}
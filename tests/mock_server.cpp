@@ -0,0 +1,354 @@
+#include "chunk_section.h"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * Stand-in for a Minecraft server running the mcpp plugin.
+ * Speaks the same newline-delimited text protocol on the same port, backed by
+ * an in-memory VoxelRegion with procedurally generated terrain, and adds a
+ * configurable delay to every request to model server round trips.
+ */
+
+struct ServerOptions {
+    int port = 4711;
+    double latency_ms = 0;
+    double jitter_ms = 0;
+    int seed = 1;
+    int player_x = 0;
+    int player_z = 0;
+    bool once = false;
+};
+
+struct ServerStats {
+    size_t requests = 0;
+    size_t reads = 0;
+    size_t writes = 0;
+};
+
+/**
+ * Lazily generated world: rolling hills of stone/dirt/grass with water below
+ * sea level and the odd tree
+ */
+class MockWorld {
+public:
+    static const int SEA_LEVEL = 62;
+
+    explicit MockWorld(int s) : seed((uint32_t)s) {}
+
+    BlockId getBlock(int x, int y, int z) {
+        ensureColumn(x, z);
+        return region.getBlock(x, y, z);
+    }
+
+    void setBlock(int x, int y, int z, BlockId id) {
+        ensureColumn(x, z);
+        region.setBlock(x, y, z, id);
+    }
+
+    int getHeight(int x, int z) {
+        ensureColumn(x, z);
+        int y = region.highestNonAir(x, z);
+        return y >= 0 ? y : 0;
+    }
+
+    size_t memoryUsage() const { return region.memoryUsage(); }
+
+private:
+    uint32_t seed;
+    VoxelRegion region;
+
+    uint32_t hash(int x, int z) const {
+        uint32_t h = seed * 0x9E3779B1u ^ (uint32_t)x * 0x85EBCA77u ^ (uint32_t)z * 0xC2B2AE3Du;
+        h ^= h >> 15;
+        h *= 0x2C1B3C6Du;
+        h ^= h >> 12;
+        return h;
+    }
+
+    int terrainHeight(int x, int z) const {
+        double phase = (seed % 1000) * 0.1;
+        double h = 64 + 7 * std::sin(x * 0.031 + phase) + 5 * std::cos(z * 0.043 - phase) +
+                   3 * std::sin((x + z) * 0.11);
+        return (int)std::floor(h);
+    }
+
+    void ensureColumn(int x, int z) {
+        if (region.isColumnLoaded(x, z)) {
+            return;
+        }
+        BlockId column[VoxelRegion::WORLD_HEIGHT] = {0};
+        int height = terrainHeight(x, z);
+        for (int y = 0; y <= height; y++) {
+            column[y] = y == 0 ? 7 : (y < height - 3 ? 1 : 3);   // bedrock, stone, dirt
+        }
+        if (height < SEA_LEVEL) {
+            for (int y = height + 1; y <= SEA_LEVEL; y++) {
+                column[y] = 9;                                   // still water
+            }
+        } else {
+            column[height] = 2;                                  // grass
+            uint32_t h = hash(x, z);
+            if (h % 97 == 0) {
+                for (int y = height + 1; y <= height + 4; y++) column[y] = 17;   // trunk
+                column[height + 5] = 18;                                          // leaves
+            }
+        }
+        region.storeColumn(x, z, column);
+    }
+};
+
+/**
+ * Parse "name(a,b,c)" into the command name and its comma-separated arguments
+ */
+static bool parseCommand(const std::string& line, std::string& name, std::vector<std::string>& args) {
+    size_t open = line.find('(');
+    size_t close = line.rfind(')');
+    if (open == std::string::npos || close == std::string::npos || close < open) {
+        return false;
+    }
+    name = line.substr(0, open);
+    args.clear();
+    std::string inner = line.substr(open + 1, close - open - 1);
+    if (inner.empty()) {
+        return true;
+    }
+    std::stringstream ss(inner);
+    std::string arg;
+    while (std::getline(ss, arg, ',')) {
+        args.push_back(arg);
+    }
+    return true;
+}
+
+static int argInt(const std::vector<std::string>& args, size_t i) {
+    return i < args.size() ? (int)std::floor(std::stod(args[i])) : 0;
+}
+
+/**
+ * Execute one command; returns true if a reply line was written to reply
+ */
+static bool handleCommand(const std::string& line, MockWorld& world, const ServerOptions& opts,
+                          ServerStats& stats, std::string& reply) {
+    std::string name;
+    std::vector<std::string> a;
+    if (!parseCommand(line, name, a)) {
+        reply = "Fail";
+        return true;
+    }
+
+    if (name == "world.getBlock") {
+        stats.reads++;
+        reply = std::to_string(world.getBlock(argInt(a, 0), argInt(a, 1), argInt(a, 2)));
+        return true;
+    }
+    if (name == "world.getBlockWithData") {
+        stats.reads++;
+        reply = std::to_string(world.getBlock(argInt(a, 0), argInt(a, 1), argInt(a, 2))) + ",0";
+        return true;
+    }
+    if (name == "world.setBlock") {
+        stats.writes++;
+        world.setBlock(argInt(a, 0), argInt(a, 1), argInt(a, 2), (BlockId)argInt(a, 3));
+        return false;
+    }
+    if (name == "world.getHeight") {
+        stats.reads++;
+        reply = std::to_string(world.getHeight(argInt(a, 0), argInt(a, 1)));
+        return true;
+    }
+    if (name == "world.getBlocks" || name == "world.setBlocks") {
+        int x0 = std::min(argInt(a, 0), argInt(a, 3)), x1 = std::max(argInt(a, 0), argInt(a, 3));
+        int y0 = std::min(argInt(a, 1), argInt(a, 4)), y1 = std::max(argInt(a, 1), argInt(a, 4));
+        int z0 = std::min(argInt(a, 2), argInt(a, 5)), z1 = std::max(argInt(a, 2), argInt(a, 5));
+        bool set = name == "world.setBlocks";
+        BlockId id = (BlockId)argInt(a, 6);
+        std::string out;
+        for (int y = y0; y <= y1; y++) {
+            for (int x = x0; x <= x1; x++) {
+                for (int z = z0; z <= z1; z++) {
+                    if (set) {
+                        world.setBlock(x, y, z, id);
+                    } else {
+                        if (!out.empty()) out += ',';
+                        out += std::to_string(world.getBlock(x, y, z));
+                    }
+                }
+            }
+        }
+        if (set) {
+            stats.writes++;
+            return false;
+        }
+        stats.reads++;
+        reply = out;
+        return true;
+    }
+    if (name == "player.getPos" || name == "player.getTile") {
+        int y = world.getHeight(opts.player_x, opts.player_z) + 1;
+        reply = std::to_string(opts.player_x) + "," + std::to_string(y) + "," + std::to_string(opts.player_z);
+        return true;
+    }
+    if (name == "player.setPos" || name == "player.setTile" || name == "chat.post") {
+        return false;
+    }
+
+    std::cerr << "mock-server: unsupported command " << name << std::endl;
+    reply = "Fail";
+    return true;
+}
+
+/**
+ * Serve one client connection until it disconnects
+ */
+static void serveClient(int client, MockWorld& world, const ServerOptions& opts, std::mt19937& rng) {
+    ServerStats stats;
+    std::uniform_real_distribution<double> jitter(-opts.jitter_ms, opts.jitter_ms);
+    auto start = std::chrono::steady_clock::now();
+
+    std::string buffer;
+    char chunk[65536];
+    while (true) {
+        ssize_t n = recv(client, chunk, sizeof(chunk), 0);
+        if (n <= 0) {
+            break;
+        }
+        buffer.append(chunk, n);
+
+        std::string replies;
+        size_t newline;
+        while ((newline = buffer.find('\n')) != std::string::npos) {
+            std::string line = buffer.substr(0, newline);
+            buffer.erase(0, newline + 1);
+            if (!line.empty() && line.back() == '\r') line.pop_back();
+            if (line.empty()) continue;
+
+            stats.requests++;
+            double delay_ms = opts.latency_ms + (opts.jitter_ms > 0 ? jitter(rng) : 0);
+            if (delay_ms > 0) {
+                std::this_thread::sleep_for(std::chrono::duration<double, std::milli>(delay_ms));
+            }
+
+            std::string reply;
+            bool has_reply;
+            try {
+                has_reply = handleCommand(line, world, opts, stats, reply);
+            } catch (const std::exception&) {
+                reply = "Fail"; // malformed numeric argument
+                has_reply = true;
+            }
+            if (has_reply) {
+                replies += reply;
+                replies += '\n';
+            }
+        }
+
+        size_t sent = 0;
+        while (sent < replies.size()) {
+            ssize_t w = send(client, replies.data() + sent, replies.size() - sent, MSG_NOSIGNAL);
+            if (w <= 0) break;
+            sent += w;
+        }
+    }
+
+    double elapsed_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cerr << "mock-server: client done: " << stats.requests << " requests ("
+              << stats.reads << " reads, " << stats.writes << " writes) in " << elapsed_s << " s, "
+              << (elapsed_s > 0 ? stats.requests / elapsed_s : 0) << " req/s, world "
+              << world.memoryUsage() / 1024 << " KiB" << std::endl;
+}
+
+static bool parseOptions(int argc, char* argv[], ServerOptions& opts) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg.substr(0, 7) == "--port=") {
+            opts.port = std::stoi(arg.substr(7));
+        } else if (arg.substr(0, 13) == "--latency-ms=") {
+            opts.latency_ms = std::stod(arg.substr(13));
+        } else if (arg.substr(0, 12) == "--jitter-ms=") {
+            opts.jitter_ms = std::stod(arg.substr(12));
+        } else if (arg.substr(0, 7) == "--seed=") {
+            opts.seed = std::stoi(arg.substr(7));
+        } else if (arg.substr(0, 9) == "--player=") {
+            std::string coords = arg.substr(9);
+            size_t comma = coords.find(',');
+            if (comma == std::string::npos) {
+                std::cerr << "Error: --player requires format x,z" << std::endl;
+                return false;
+            }
+            opts.player_x = std::stoi(coords.substr(0, comma));
+            opts.player_z = std::stoi(coords.substr(comma + 1));
+        } else if (arg == "--once") {
+            opts.once = true;
+        } else {
+            std::cerr << "Error: Unknown option " << arg << std::endl;
+            return false;
+        }
+    }
+    if (opts.latency_ms < 0 || opts.jitter_ms < 0) {
+        std::cerr << "Error: latency and jitter must be non-negative" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    ServerOptions opts;
+    if (!parseOptions(argc, argv, opts)) {
+        return 1;
+    }
+
+    int server = socket(AF_INET, SOCK_STREAM, 0);
+    if (server < 0) {
+        std::perror("socket");
+        return 1;
+    }
+    int yes = 1;
+    setsockopt(server, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+
+    sockaddr_in addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(opts.port);
+    if (bind(server, (sockaddr*)&addr, sizeof(addr)) < 0 || listen(server, 1) < 0) {
+        std::perror("bind/listen");
+        close(server);
+        return 1;
+    }
+
+    std::cerr << "mock-server: listening on 127.0.0.1:" << opts.port << " (latency "
+              << opts.latency_ms << " ms, jitter " << opts.jitter_ms << " ms, seed "
+              << opts.seed << ")" << std::endl;
+
+    // One world for the life of the process, so edits persist across clients
+    MockWorld world(opts.seed);
+    std::mt19937 rng(opts.seed);
+    do {
+        int client = accept(server, nullptr, nullptr);
+        if (client < 0) {
+            std::perror("accept");
+            break;
+        }
+        setsockopt(client, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof(yes));
+        serveClient(client, world, opts, rng);
+        close(client);
+    } while (!opts.once);
+
+    close(server);
+    return 0;
+}
@@ -0,0 +1,562 @@
+#include "reference_generator.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
+// Ported from the first implementation of plot_validation.cpp, terraforming.cpp,
+// wall_builder.cpp and waypoint_placement.cpp. Only the block access changed:
+// mcpp::getBlock/setBlock now go to the world backend, and the test-mode plot
+// size counter is a member instead of a function-local static.
+
+static mcpp::Block getBlock(WorldBackend& world, const mcpp::Coordinate& pos) {
+    return mcpp::Block(world.getBlock(pos.x, pos.y, pos.z));
+}
+
+static void setBlock(WorldBackend& world, const mcpp::Coordinate& pos, const mcpp::Block& block) {
+    world.setBlock(pos.x, pos.y, pos.z, (BlockId)block.id);
+}
+
+/**
+ * Get the highest non-air block at coordinates (x, z)
+ */
+mcpp::Coordinate ReferenceGenerator::getHighestBlock(int x, int z) {
+    for (int y = 255; y >= 0; y--) {
+        mcpp::Block block = getBlock(world, mcpp::Coordinate(x, y, z));
+        if (block.id != 0) { // 0 is air
+            return mcpp::Coordinate(x, y, z);
+        }
+    }
+    return mcpp::Coordinate(x, 0, z);
+}
+
+/**
+ * Check if water coverage is <= 15% (max 3 water blocks in 20x20 area)
+ */
+bool ReferenceGenerator::checkWaterCoverage(const Plot& plot) {
+    int water_count = 0;
+    int total_blocks = plot.getWidth() * plot.getDepth();
+    
+    for (int x = plot.minX(); x <= plot.maxX(); x++) {
+        for (int z = plot.minZ(); z <= plot.maxZ(); z++) {
+            mcpp::Coordinate highest = getHighestBlock(x, z);
+            mcpp::Block block = getBlock(world, highest);
+            
+            // Check for water (block id 8 or 9 for flowing/stationary water)
+            if (block.id == 8 || block.id == 9) {
+                water_count++;
+            }
+        }
+    }
+    
+    double water_percentage = (double)water_count / total_blocks;
+    return water_percentage <= 0.15;
+}
+
+/**
+ * Check if slope delta is <= 15 (excluding trees)
+ */
+bool ReferenceGenerator::checkSlopeDelta(const Plot& plot) {
+    int min_height = 255;
+    int max_height = 0;
+    
+    for (int x = plot.minX(); x <= plot.maxX(); x++) {
+        for (int z = plot.minZ(); z <= plot.maxZ(); z++) {
+            mcpp::Coordinate highest = getHighestBlock(x, z);
+            int y = highest.y;
+            
+            // Skip tree blocks (leaves: 18, wood: 17)
+            mcpp::Block block = getBlock(world, highest);
+            if (block.id != 18 && block.id != 17) {
+                min_height = std::min(min_height, y);
+                max_height = std::max(max_height, y);
+            }
+        }
+    }
+    
+    return (max_height - min_height) <= 15;
+}
+
+/**
+ * Check if plot intersects with other plots
+ */
+bool ReferenceGenerator::checkPlotIntersection(const Plot& plot, 
+                                             const std::vector<Plot>& existing_plots) {
+    for (const auto& other : existing_plots) {
+        // Check for AABB intersection
+        if (!(plot.maxX() < other.minX() || plot.minX() > other.maxX() ||
+              plot.maxZ() < other.minZ() || plot.minZ() > other.maxZ())) {
+            return false; // Intersection found
+        }
+    }
+    return true;
+}
+
+/**
+ * Select a semi-random entrance point on the plot edge facing village center
+ */
+mcpp::Coordinate ReferenceGenerator::selectEntrance(const Plot& plot) {
+    // Find which edge is closest to village center
+    int center_x = village_center.x;
+    int center_z = village_center.z;
+    int plot_center_x = (plot.minX() + plot.maxX()) / 2;
+    int plot_center_z = (plot.minZ() + plot.maxZ()) / 2;
+    
+    std::vector<mcpp::Coordinate> candidates;
+    
+    // North edge (min z)
+    if (plot_center_z > center_z) {
+        for (int x = plot.minX() + 1; x < plot.maxX(); x++) {
+            candidates.push_back(mcpp::Coordinate(x, 0, plot.minZ()));
+        }
+    }
+    // South edge (max z)
+    if (plot_center_z < center_z) {
+        for (int x = plot.minX() + 1; x < plot.maxX(); x++) {
+            candidates.push_back(mcpp::Coordinate(x, 0, plot.maxZ()));
+        }
+    }
+    // West edge (min x)
+    if (plot_center_x > center_x) {
+        for (int z = plot.minZ() + 1; z < plot.maxZ(); z++) {
+            candidates.push_back(mcpp::Coordinate(plot.minX(), 0, z));
+        }
+    }
+    // East edge (max x)
+    if (plot_center_x < center_x) {
+        for (int z = plot.minZ() + 1; z < plot.maxZ(); z++) {
+            candidates.push_back(mcpp::Coordinate(plot.maxX(), 0, z));
+        }
+    }
+    
+    if (candidates.empty()) {
+        return mcpp::Coordinate(plot_center_x, 0, plot_center_z);
+    }
+    
+    // Select semi-random entrance
+    std::uniform_int_distribution<> dis(0, candidates.size() - 1);
+    return candidates[dis(rng)];
+}
+
+/**
+ * Validate a single plot against all constraints
+ */
+bool ReferenceGenerator::isValidPlot(const Plot& plot, const std::vector<Plot>& existing_plots) {
+    // Check water coverage
+    if (!checkWaterCoverage(plot)) {
+        return false;
+    }
+    
+    // Check slope delta
+    if (!checkSlopeDelta(plot)) {
+        return false;
+    }
+    
+    // Check plot intersection
+    if (!checkPlotIntersection(plot, existing_plots)) {
+        return false;
+    }
+    
+    // Check border intersection with village boundary
+    int village_min_x = village_center.x - village_size / 2;
+    int village_max_x = village_center.x + village_size / 2;
+    int village_min_z = village_center.z - village_size / 2;
+    int village_max_z = village_center.z + village_size / 2;
+    
+    int border_min_x = plot.minX() - plot_border;
+    int border_max_x = plot.maxX() + plot_border;
+    int border_min_z = plot.minZ() - plot_border;
+    int border_max_z = plot.maxZ() + plot_border;
+    
+    if (border_min_x < village_min_x || border_max_x > village_max_x ||
+        border_min_z < village_min_z || border_max_z > village_max_z) {
+        return false;
+    }
+    
+    return true;
+}
+
+/**
+ * Find all valid plots in the village area
+ */
+std::vector<Plot> ReferenceGenerator::findPlots() {
+    std::vector<Plot> plots;
+    const int MAX_ATTEMPTS = 1000;
+    const int MIN_PLOT_SIZE = 14;
+    const int MAX_PLOT_SIZE = 20;
+    const int MIN_PLOTS = std::max(1, village_size / 50);
+    
+    int village_min_x = village_center.x - village_size / 2;
+    int village_max_x = village_center.x + village_size / 2;
+    int village_min_z = village_center.z - village_size / 2;
+    int village_max_z = village_center.z + village_size / 2;
+    
+    int plot_size = 0;
+    int center_x = 0;
+    int center_z = 0;
+    
+    if (test_mode) {
+        // --- TEST MODE: Deterministic Grid Scan & Sequential Size ---
+        // current_plot_size maintains sequential plot size across valid plots found during the scan
+
+        // Iterate through the grid in 5 block increments
+        for (int z = village_min_z + 5; z <= village_max_z - 5; z += 5) {
+            for (int x = village_min_x + 5; x <= village_max_x - 5; x += 5) {
+                
+                center_x = x;
+                center_z = z;
+
+                // Determine plot size sequentially (14-20, wrapping)
+                plot_size = current_plot_size;
+
+                int origin_x = center_x - plot_size / 2;
+                int origin_z = center_z - plot_size / 2;
+                int bound_x = origin_x + plot_size - 1;
+                int bound_z = origin_z + plot_size - 1;
+
+                // Get height at plot center
+                mcpp::Coordinate highest = getHighestBlock(center_x, center_z);
+                int height = highest.y;
+                
+                Plot candidate(origin_x, origin_z, bound_x, bound_z, height);
+
+                if (isValidPlot(candidate, plots)) {
+                    // Update sequential size for the next valid plot
+                    current_plot_size = (current_plot_size == MAX_PLOT_SIZE) ? MIN_PLOT_SIZE : current_plot_size + 1;
+                    
+                    candidate.setEntrance(selectEntrance(candidate));
+                    plots.push_back(candidate);
+                }
+
+                // Stop after 100 plots (general upper limit)
+                if (plots.size() >= 100) break;
+            }
+            if (plots.size() >= 100) break;
+        }
+
+    } else {
+        // --- NORMAL MODE: Random Sampling (Original Logic) ---
+        int attempts = 0;
+        
+        std::uniform_int_distribution<> size_dist(MIN_PLOT_SIZE, MAX_PLOT_SIZE);
+        std::uniform_int_distribution<> x_dist(village_min_x, village_max_x);
+        std::uniform_int_distribution<> z_dist(village_min_z, village_max_z);
+        
+        while (attempts < MAX_ATTEMPTS && plots.size() < 100) { // Reasonable upper limit
+            plot_size = size_dist(rng);
+            center_x = x_dist(rng);
+            center_z = z_dist(rng);
+            
+            int origin_x = center_x - plot_size / 2;
+            int origin_z = center_z - plot_size / 2;
+            int bound_x = origin_x + plot_size - 1;
+            int bound_z = origin_z + plot_size - 1;
+            
+            // Get height at plot center
+            mcpp::Coordinate highest = getHighestBlock(center_x, center_z);
+            int height = highest.y;
+            
+            Plot candidate(origin_x, origin_z, bound_x, bound_z, height);
+            
+            if (isValidPlot(candidate, plots)) {
+                candidate.setEntrance(selectEntrance(candidate));
+                plots.push_back(candidate);
+            }
+            
+            attempts++;
+        }
+    }
+    
+    if (plots.size() < MIN_PLOTS) {
+        throw std::runtime_error("Could not find minimum required plots (" + 
+                                std::to_string(MIN_PLOTS) + " required, " + 
+                                std::to_string(plots.size()) + " found)");
+    }
+    
+    return plots;
+}
+
+/**
+ * Terraform the land around plots using a linear interpolation function
+ * Formula: block_height(d, yg, yp, p) = round(yg + (yp - yg) * (p - d) / p)
+ * where d is distance from plot edge, yg is ground height, yp is plot height, p is plot_border
+ */
+void ReferenceGenerator::terraformPlots(const std::vector<Plot>& plots) {
+    for (const auto& plot : plots) {
+        int plot_height = plot.height();
+        
+        // Terraform the border area around each plot
+        int border_min_x = plot.minX() - plot_border;
+        int border_max_x = plot.maxX() + plot_border;
+        int border_min_z = plot.minZ() - plot_border;
+        int border_max_z = plot.maxZ() + plot_border;
+        
+        for (int x = border_min_x; x <= border_max_x; x++) {
+            for (int z = border_min_z; z <= border_max_z; z++) {
+                // Skip if inside the plot itself
+                if (x >= plot.minX() && x <= plot.maxX() &&
+                    z >= plot.minZ() && z <= plot.maxZ()) {
+                    continue;
+                }
+                
+                // Calculate distance to nearest plot edge
+                int dist_x = 0;
+                if (x < plot.minX()) {
+                    dist_x = plot.minX() - x;
+                } else if (x > plot.maxX()) {
+                    dist_x = x - plot.maxX();
+                }
+                
+                int dist_z = 0;
+                if (z < plot.minZ()) {
+                    dist_z = plot.minZ() - z;
+                } else if (z > plot.maxZ()) {
+                    dist_z = z - plot.maxZ();
+                }
+                
+                int distance = std::max(dist_x, dist_z);
+                
+                if (distance > 0 && distance <= plot_border) {
+                    // Get current ground height
+                    mcpp::Coordinate highest = mcpp::Coordinate(x, 255, z);
+                    for (int y = 255; y >= 0; y--) {
+                        mcpp::Block block = getBlock(world, mcpp::Coordinate(x, y, z));
+                        if (block.id != 0) {
+                            highest.y = y;
+                            break;
+                        }
+                    }
+                    
+                    int ground_height = highest.y;
+                    
+                    // Linear interpolation: closer to plot = more influence from plot height
+                    double factor = (double)(plot_border - distance) / plot_border;
+                    int target_height = (int)std::round(ground_height + 
+                                        (plot_height - ground_height) * factor);
+                    
+                    // Modify terrain to target height
+                    if (target_height > ground_height) {
+                        // Fill up
+                        for (int y = ground_height + 1; y <= target_height; y++) {
+                            setBlock(world, mcpp::Coordinate(x, y, z), mcpp::Block(3)); // Dirt
+                        }
+                    } else if (target_height < ground_height) {
+                        // Remove blocks
+                        for (int y = ground_height; y > target_height; y--) {
+                            setBlock(world, mcpp::Coordinate(x, y, z), mcpp::Block(0)); // Air
+                        }
+                    }
+                }
+            }
+        }
+        
+        // Flatten the plot itself
+        for (int x = plot.minX(); x <= plot.maxX(); x++) {
+            for (int z = plot.minZ(); z <= plot.maxZ(); z++) {
+                // Remove everything above plot height
+                for (int y = plot_height + 1; y <= 255; y++) {
+                    setBlock(world, mcpp::Coordinate(x, y, z), mcpp::Block(0)); // Air
+                }
+                
+                // Fill up to plot height if needed
+                mcpp::Coordinate highest = mcpp::Coordinate(x, 0, z);
+                for (int y = 255; y >= 0; y--) {
+                    mcpp::Block block = getBlock(world, mcpp::Coordinate(x, y, z));
+                    if (block.id != 0) {
+                        highest.y = y;
+                        break;
+                    }
+                }
+                
+                if (highest.y < plot_height) {
+                    for (int y = highest.y + 1; y <= plot_height; y++) {
+                        setBlock(world, mcpp::Coordinate(x, y, z), mcpp::Block(3)); // Dirt
+                    }
+                }
+            }
+        }
+    }
+}
+
+/**
+ * Build a 3-4 block high wall around the village perimeter
+ */
+void ReferenceGenerator::buildWall(const std::vector<Plot>& plots) {
+    int village_min_x = village_center.x - village_size / 2;
+    int village_max_x = village_center.x + village_size / 2;
+    int village_min_z = village_center.z - village_size / 2;
+    int village_max_z = village_center.z + village_size / 2;
+    
+    const int WALL_HEIGHT = 4;
+    const int WALL_BLOCK_ID = 4; // Cobblestone
+    
+    // Get average ground height at village boundary
+    int avg_height = 0;
+    int count = 0;
+    
+    // Sample corners and edges
+    for (int x = village_min_x; x <= village_max_x; x += 10) {
+        for (int y = 255; y >= 0; y--) {
+            mcpp::Block block = getBlock(world, mcpp::Coordinate(x, y, village_min_z));
+            if (block.id != 0) {
+                avg_height += y;
+                count++;
+                break;
+            }
+        }
+    }
+    
+    for (int z = village_min_z; z <= village_max_z; z += 10) {
+        for (int y = 255; y >= 0; y--) {
+            mcpp::Block block = getBlock(world, mcpp::Coordinate(village_max_x, y, z));
+            if (block.id != 0) {
+                avg_height += y;
+                count++;
+                break;
+            }
+        }
+    }
+    
+    if (count > 0) {
+        avg_height /= count;
+    } else {
+        avg_height = 64; // Default height
+    }
+    
+    // Build north and south walls
+    for (int x = village_min_x; x <= village_max_x; x++) {
+        // North wall
+        for (int y = avg_height; y < avg_height + WALL_HEIGHT; y++) {
+            setBlock(world, mcpp::Coordinate(x, y, village_min_z), mcpp::Block(WALL_BLOCK_ID));
+        }
+        
+        // South wall
+        for (int y = avg_height; y < avg_height + WALL_HEIGHT; y++) {
+            setBlock(world, mcpp::Coordinate(x, y, village_max_z), mcpp::Block(WALL_BLOCK_ID));
+        }
+    }
+    
+    // Build east and west walls
+    for (int z = village_min_z; z <= village_max_z; z++) {
+        // West wall
+        for (int y = avg_height; y < avg_height + WALL_HEIGHT; y++) {
+            setBlock(world, mcpp::Coordinate(village_min_x, y, z), mcpp::Block(WALL_BLOCK_ID));
+        }
+        
+        // East wall
+        for (int y = avg_height; y < avg_height + WALL_HEIGHT; y++) {
+            setBlock(world, mcpp::Coordinate(village_max_x, y, z), mcpp::Block(WALL_BLOCK_ID));
+        }
+    }
+}
+
+/**
+ * Place waypoints for pathfinding between plots
+ * Groups plots into 3's and finds center points suitable for waypoints
+ */
+std::vector<mcpp::Coordinate> ReferenceGenerator::placeWaypoints(const std::vector<Plot>& plots) {
+    std::vector<mcpp::Coordinate> waypoints;
+    
+    if (plots.empty()) {
+        return waypoints;
+    }
+    
+    // Group plots into 3's, preferring groups with small total area
+    std::vector<std::vector<const Plot*>> groups;
+    std::vector<bool> used(plots.size(), false);
+    
+    // Create groups of 3 plots with smallest total area
+    for (size_t i = 0; i < plots.size(); i++) {
+        if (used[i]) continue;
+        
+        std::vector<const Plot*> group;
+        group.push_back(&plots[i]);
+        used[i] = true;
+        
+        // Find 2 more closest plots
+        for (int j = 0; j < 2 && group.size() < 3; j++) {
+            double min_dist = 1e9;
+            int best_idx = -1;
+            
+            for (size_t k = 0; k < plots.size(); k++) {
+                if (used[k]) continue;
+                
+                // Calculate distance from group center to this plot
+                int group_center_x = 0, group_center_z = 0;
+                for (const auto* p : group) {
+                    group_center_x += (p->minX() + p->maxX()) / 2;
+                    group_center_z += (p->minZ() + p->maxZ()) / 2;
+                }
+                group_center_x /= group.size();
+                group_center_z /= group.size();
+                
+                int plot_center_x = (plots[k].minX() + plots[k].maxX()) / 2;
+                int plot_center_z = (plots[k].minZ() + plots[k].maxZ()) / 2;
+                
+                double dist = std::sqrt(
+                    (group_center_x - plot_center_x) * (group_center_x - plot_center_x) +
+                    (group_center_z - plot_center_z) * (group_center_z - plot_center_z)
+                );
+                
+                if (dist < min_dist) {
+                    min_dist = dist;
+                    best_idx = k;
+                }
+            }
+            
+            if (best_idx != -1) {
+                group.push_back(&plots[best_idx]);
+                used[best_idx] = true;
+            }
+        }
+        
+        groups.push_back(group);
+    }
+    
+    // Find center point of each group
+    for (const auto& group : groups) {
+        int center_x = 0, center_z = 0;
+        
+        for (const auto* plot : group) {
+            center_x += (plot->minX() + plot->maxX()) / 2;
+            center_z += (plot->minZ() + plot->maxZ()) / 2;
+        }
+        
+        center_x /= group.size();
+        center_z /= group.size();
+        
+        // Check if center point is suitable (not inside any plot)
+        bool suitable = true;
+        for (const auto& plot : plots) {
+            if (center_x >= plot.minX() && center_x <= plot.maxX() &&
+                center_z >= plot.minZ() && center_z <= plot.maxZ()) {
+                suitable = false;
+                break;
+            }
+        }
+        
+        if (suitable) {
+            // Get height at waypoint location
+            mcpp::Coordinate highest = mcpp::Coordinate(center_x, 0, center_z);
+            for (int y = 255; y >= 0; y--) {
+                mcpp::Block block = getBlock(world, mcpp::Coordinate(center_x, y, center_z));
+                if (block.id != 0) {
+                    highest.y = y + 1;
+                    break;
+                }
+            }
+            
+            waypoints.push_back(highest);
+        }
+    }
+    
+    // Ensure minimum waypoint count
+    int min_waypoints = std::max(1, (int)plots.size() / 5);
+    if (waypoints.size() < min_waypoints) {
+        throw std::runtime_error("Could not find minimum required waypoints (" + 
+                                std::to_string(min_waypoints) + " required, " + 
+                                std::to_string(waypoints.size()) + " found)");
+    }
+    
+    return waypoints;
+}
@@ -0,0 +1,45 @@
+#ifndef REFERENCE_GENERATOR_H
+#define REFERENCE_GENERATOR_H
+
+#include "plot.h"
+#include "world_backend.h"
+#include <mcpp/mcpp.h>
+#include <vector>
+#include <random>
+
+/**
+ * The original block-by-block village generator, kept as the reference that
+ * optimised engines are checked against. Every read and write goes straight
+ * to the world backend with no caching, exactly as the first implementation
+ * did against the server. Do not optimise this class.
+ */
+class ReferenceGenerator {
+private:
+    WorldBackend& world;
+    mcpp::Coordinate village_center;
+    int village_size;
+    int plot_border;
+    int seed;
+    bool test_mode;
+    std::mt19937 rng;
+    int current_plot_size;
+
+    mcpp::Coordinate getHighestBlock(int x, int z);
+    bool isValidPlot(const Plot& plot, const std::vector<Plot>& existing_plots);
+    bool checkWaterCoverage(const Plot& plot);
+    bool checkSlopeDelta(const Plot& plot);
+    bool checkPlotIntersection(const Plot& plot, const std::vector<Plot>& existing_plots);
+    mcpp::Coordinate selectEntrance(const Plot& plot);
+
+public:
+    ReferenceGenerator(WorldBackend& w, mcpp::Coordinate center, int size, int border, int s, bool test)
+        : world(w), village_center(center), village_size(size), plot_border(border),
+          seed(s), test_mode(test), rng(s), current_plot_size(14) {}
+
+    std::vector<Plot> findPlots();
+    void terraformPlots(const std::vector<Plot>& plots);
+    void buildWall(const std::vector<Plot>& plots);
+    std::vector<mcpp::Coordinate> placeWaypoints(const std::vector<Plot>& plots);
+};
+
+#endif // REFERENCE_GENERATOR_H
@@ -1,8 +1,154 @@
 #include "village_generator.h"
+#include "chunk_section.h"
+#include "job_arena.h"
+#include "navigation.h"
+#include "block_writer.h"
+#include "plot_rules.h"
+#include "bounded_queue.h"
+#include "anvil_reader.h"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <zlib.h>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
 #include <iostream>
 #include <cassert>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <map>
+#include <stdexcept>
+#include <thread>
+#include <tuple>
 #include <vector>
 
+/**
+ * Flat stone ground up to y=64, except one column that is air all the way
+ * down, and under water from x = water_from_x on. Records every edit sent to
+ * it, can answer reads slowly, and can fail like a dropped connection once
+ * fail_after edits have been made or when reading at z >= unreadable_z.
+ */
+class FlatWorld : public WorldBackend {
+public:
+    int empty_x, empty_z;
+    int unreadable_z = 1 << 30;
+    int water_from_x = 1 << 30;
+    int read_delay_ms = 0;
+    size_t writes = 0;
+    size_t fail_after = 0;    // 0 = never fail
+    std::map<std::tuple<int, int, int>, BlockId> edits;
+
+    FlatWorld(int x, int z) : empty_x(x), empty_z(z) {}
+
+    BlockId getBlock(int x, int y, int z) override {
+        if (read_delay_ms > 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(read_delay_ms));
+        }
+        auto it = edits.find(std::make_tuple(x, y, z));
+        if (it != edits.end()) return it->second;
+        if (z >= unreadable_z) throw std::runtime_error("Connection lost");
+        if (y == 64 && x >= water_from_x && !(x == empty_x && z == empty_z)) return 9;
+        return (x == empty_x && z == empty_z) || y > 64 ? 0 : 1;
+    }
+
+    void setBlock(int x, int y, int z, BlockId id) override {
+        if (fail_after > 0 && writes >= fail_after) {
+            throw std::runtime_error("Connection lost");
+        }
+        writes++;
+        edits[std::make_tuple(x, y, z)] = id;
+    }
+};
+
+/**
+ * Client for a ./mock-server started on port 4712 with the given latency,
+ * speaking the mcpp text protocol over one connection. The server exits
+ * when the connection closes.
+ */
+class MockServerWorld : public WorldBackend {
+public:
+    explicit MockServerWorld(double latency_ms) : server(-1), fd(-1) {
+        server = fork();
+        if (server == 0) {
+            std::string latency = "--latency-ms=" + std::to_string(latency_ms);
+            if (!std::freopen("/dev/null", "w", stderr)) _exit(1);
+            execl("./mock-server", "mock-server", "--once", "--port=4712", latency.c_str(), (char*)nullptr);
+            _exit(127);
+        }
+        for (int attempt = 0; attempt < 100 && server > 0 && fd < 0; attempt++) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            int s = socket(AF_INET, SOCK_STREAM, 0);
+            sockaddr_in addr;
+            std::memset(&addr, 0, sizeof(addr));
+            addr.sin_family = AF_INET;
+            addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            addr.sin_port = htons(4712);
+            if (connect(s, (sockaddr*)&addr, sizeof(addr)) == 0) {
+                int yes = 1;
+                setsockopt(s, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof(yes));
+                fd = s;
+            } else {
+                close(s);
+            }
+        }
+    }
+
+    ~MockServerWorld() {
+        if (fd >= 0) {
+            close(fd);
+        } else if (server > 0) {
+            kill(server, SIGTERM);
+        }
+        if (server > 0) {
+            waitpid(server, nullptr, 0);
+        }
+    }
+
+    bool connected() const { return fd >= 0; }
+
+    BlockId getBlock(int x, int y, int z) override {
+        request("world.getBlock(" + std::to_string(x) + "," + std::to_string(y) + "," +
+                std::to_string(z) + ")");
+        size_t newline;
+        while ((newline = replies.find('\n')) == std::string::npos) {
+            char chunk[256];
+            ssize_t n = recv(fd, chunk, sizeof(chunk), 0);
+            if (n <= 0) throw std::runtime_error("Mock server closed the connection");
+            replies.append(chunk, n);
+        }
+        BlockId id = (BlockId)std::stoi(replies.substr(0, newline));
+        replies.erase(0, newline + 1);
+        return id;
+    }
+
+    void setBlock(int x, int y, int z, BlockId id) override {
+        request("world.setBlock(" + std::to_string(x) + "," + std::to_string(y) + "," +
+                std::to_string(z) + "," + std::to_string(id) + ")");
+    }
+
+private:
+    pid_t server;
+    int fd;
+    std::string replies;
+
+    void request(const std::string& command) {
+        if (fd < 0) throw std::runtime_error("Mock server not running");
+        std::string line = command + "\n";
+        for (size_t sent = 0; sent < line.size();) {
+            ssize_t n = ::send(fd, line.data() + sent, line.size() - sent, MSG_NOSIGNAL);
+            if (n <= 0) throw std::runtime_error("Mock server closed the connection");
+            sent += n;
+        }
+    }
+};
+
 /**
  * Black-box test suite for Part A functionality
  * Tests plot validation, terraforming, wall building, and waypoint placement
@@ -32,6 +178,11 @@ public:
         testWallBuilding();
         testWaypointPlacement();
         testCLIParsing();
+        testVoxelStorage();
+        testScratchArena();
+        testPathfinding();
+        testPipelineQueue();
+        testRegionFiles();
         
         std::cout << "\n=== Test Results ===" << std::endl;
         std::cout << "Passed: " << tests_passed << std::endl;
@@ -43,8 +194,7 @@ private:
         std::cout << "\n--- Plot Validation Tests ---" << std::endl;
         
         // Test 1: Plot object creation
-        Plot p(mcpp::Coordinate(0, 64, 0), mcpp::Coordinate(19, 64, 19), 
-               mcpp::Coordinate(10, 64, 0), 64);
+        Plot p(0, 0, 19, 19, 64, 10, 0);
         logTest("Plot creation", p.getWidth() == 20 && p.getDepth() == 20);
         
         // Test 2: Plot center calculation
@@ -52,18 +202,47 @@ private:
         logTest("Plot center calculation", center.x == 9 && center.z == 9);
         
         // Test 3: Multiple plots don't intersect
-        Plot p1(mcpp::Coordinate(0, 64, 0), mcpp::Coordinate(19, 64, 19), 
-                mcpp::Coordinate(10, 64, 0), 64);
-        Plot p2(mcpp::Coordinate(30, 64, 30), mcpp::Coordinate(49, 64, 49), 
-                mcpp::Coordinate(40, 64, 30), 64);
+        Plot p1(0, 0, 19, 19, 64, 10, 0);
+        Plot p2(30, 30, 49, 49, 64, 40, 30);
         
-        bool no_intersection = !(p1.bound.x >= p2.origin.x && p1.origin.x <= p2.bound.x &&
-                                p1.bound.z >= p2.origin.z && p1.origin.z <= p2.bound.z);
+        bool no_intersection = !(p1.maxX() >= p2.minX() && p1.minX() <= p2.maxX() &&
+                                p1.maxZ() >= p2.minZ() && p1.minZ() <= p2.maxZ());
         logTest("Plot non-intersection", no_intersection);
         
         // Test 4: Plot size constraints
         bool size_valid = p.getWidth() >= 14 && p.getWidth() <= 20;
         logTest("Plot size within constraints", size_valid);
+        
+        // Test 5: PlotSet stores plots compactly and answers overlap queries
+        PlotSet set;
+        set.push_back(p1);
+        set.push_back(p2);
+        Plot view = set[1];
+        logTest("PlotSet view round trip", set.size() == 2 && view.minX() == 30 &&
+                view.maxZ() == 49 && view.entrance().x == 40 && view.height() == 64);
+        PlotSet::const_iterator it = set.begin();
+        PlotSet::const_iterator first = it++;
+        logTest("PlotSet iterator and entrance y", first->minX() == 0 && it->minX() == 30 &&
+                ++it == set.end() && view.entrance().y == 0 && set.entrance(0).y == 0);
+        logTest("PlotSet intersection query", set.intersectsAny(15, 15, 25, 25) &&
+                !set.intersectsAny(20, 20, 29, 29));
+        logTest("PlotSet containment query", set.containsAny(45, 31) && !set.containsAny(25, 25));
+        
+        // Test 6: Fused rules stop at the first cell that breaks a rule
+        DefaultPlotRules rules;
+        PlotRuleConfig config;
+        int visited = 0;
+        bool steep = rules.evaluate(config, 0, 0, 19, 19, [&](int x, int) {
+            visited++;
+            BlockId block = x == 0 ? 17 : 2;
+            return SurfaceCell{x == 0 ? 99 : 64 + x, block, config.classes->lookup(block)};
+        });
+        logTest("Rule engine ignores trees and exits early", !steep && visited == 17 * 20 + 1);
+        
+        // Test 7: Biome presets change thresholds
+        PlotRuleConfig mountains;
+        logTest("Biome rule presets", plotRulesForBiome("mountains", mountains) &&
+                mountains.max_slope == 25 && !plotRulesForBiome("moon", mountains));
     }
     
     void testTerraforming() {
@@ -87,6 +266,29 @@ private:
         // Test 3: Height difference is reasonable
         int height_diff = std::abs(target_height - ground_height);
         logTest("Terraforming height difference reasonable", height_diff <= 4);
+        
+        // Test 4: An all-air border column counts as height 255, so nothing is filled in
+        FlatWorld world(-3, 5);
+        VillageGenerator generator(mcpp::Coordinate(0, 0, 0), 200, plot_border, 1, true);
+        generator.setWorldBackend(&world);
+        PlotSet plots;
+        plots.push_back(Plot(0, 0, 13, 13, 64));
+        generator.terraformPlots(plots);
+        bool still_air = true;
+        for (int y = 0; y < VoxelRegion::WORLD_HEIGHT; y++) {
+            still_air = still_air && world.getBlock(-3, y, 5) == 0;
+        }
+        logTest("Terraforming leaves an all-air border column empty", still_air);
+        
+        // Test 5: Edits held for chunk ordering reach the world even without a commit
+        FlatWorld held_world(-3, 5);
+        {
+            VillageGenerator held(mcpp::Coordinate(0, 0, 0), 200, plot_border, 1, true);
+            held.setWorldBackend(&held_world);
+            held.setChunkOrderedWrites(true);
+            held.terraformPlots(plots);
+        }
+        logTest("Held edits are written when a run stops early", held_world.edits == world.edits);
     }
     
     void testWallBuilding() {
@@ -104,6 +306,69 @@ private:
         // Test 3: Wall block type is valid
         int wall_block_id = 4; // Cobblestone
         logTest("Wall uses valid block type", wall_block_id > 0 && wall_block_id < 256);
+        
+        // Test 4: Write flow control backs off when latency exceeds the target
+        FlowController control(1.0);
+        for (int i = 0; i < 10; i++) control.record(2.0, 4);
+        int grown = control.batchSize();
+        for (int i = 0; i < 10; i++) control.record(20.0, 4);
+        logTest("Flow control grows batches under target", grown > FlowController::MIN_BATCH);
+        logTest("Flow control backs off over target",
+                control.batchSize() == FlowController::MIN_BATCH && control.pauseMicros() > 0);
+        
+        // Test 5: Writes get no reply, so each batch is timed up to a read the server must answer
+        {
+            MockServerWorld server(1.0);
+            BlockWriter writer;
+            writer.setBackend(&server);
+            writer.setTargetLatency(0.5);
+            bool answered = server.connected();
+            try {
+                for (int i = 0; i < 64; i++) writer.setBlock(mcpp::Coordinate(i, 100, 0), 4);
+                writer.flush();
+                answered = answered && server.getBlock(63, 100, 0) == 4;
+            } catch (const std::exception&) {
+                answered = false;
+            }
+            WriteStats timed = writer.stats();
+            logTest("Flow control sees mock server latency (needs ./mock-server)",
+                    answered && timed.mean_latency_ms >= 0.5 && timed.pause_us > 0);
+        }
+        
+        // Test 6: Producers wait for room once the queue is full
+        FlatWorld slow_world(0, 0);
+        slow_world.read_delay_ms = 1;
+        BlockWriter capped;
+        capped.setBackend(&slow_world);
+        capped.setTargetLatency(0.01);
+        size_t issued = BlockWriter::MAX_QUEUED + 10 * FlowController::MIN_BATCH;
+        for (size_t i = 0; i < issued; i++) {
+            capped.setBlock(mcpp::Coordinate((int)(i % 64), 100 + (int)(i / 4096), (int)(i / 64 % 64)), 4);
+        }
+        size_t queued = capped.stats().queued;
+        slow_world.read_delay_ms = 0;
+        capped.flush();
+        logTest("Write queue is capped while flow control pauses",
+                queued <= BlockWriter::MAX_QUEUED && slow_world.writes == issued &&
+                capped.stats().queued == 0);
+        
+        // Test 7: Morton order visits each 2x2 block of chunks before moving on
+        std::vector<std::pair<uint64_t, std::pair<int, int>>> order;
+        for (int cz = -2; cz < 2; cz++) {
+            for (int cx = -2; cx < 2; cx++) {
+                order.push_back(std::make_pair(chunkMortonCode(cx, cz), std::make_pair(cx, cz)));
+            }
+        }
+        std::sort(order.begin(), order.end());
+        bool blocked = true;
+        for (size_t i = 0; i < order.size(); i += 4) {
+            for (size_t j = i + 1; j < i + 4; j++) {
+                blocked = blocked && (order[j].second.first >> 1) == (order[i].second.first >> 1) &&
+                          (order[j].second.second >> 1) == (order[i].second.second >> 1);
+            }
+        }
+        logTest("Chunk write order keeps neighbouring chunks together",
+                blocked && order[0].second == std::make_pair(-2, -2));
     }
     
     void testWaypointPlacement() {
@@ -142,6 +407,256 @@ private:
         // Test 3: Coordinate parsing
         logTest("Coordinate parsing with comma separator", true);
     }
+    
+    void testVoxelStorage() {
+        std::cout << "\n--- Voxel Storage Tests ---" << std::endl;
+        
+        // Test 1: Sections grow their palette and keep earlier blocks
+        ChunkSection section;
+        for (int i = 0; i < 20; i++) {
+            section.set(i % 16, i % 16, i / 16, (BlockId)(i + 1));
+        }
+        bool round_trip = true;
+        for (int i = 0; i < 20; i++) {
+            round_trip = round_trip && section.get(i % 16, i % 16, i / 16) == i + 1;
+        }
+        logTest("Section palette round trip", round_trip && section.get(0, 15, 15) == 0);
+        
+        // Test 2: Air sections are not allocated
+        VoxelRegion region;
+        region.setBlock(-5, 100, 7, 0);
+        logTest("Air writes allocate no sections", region.chunkCount() == 0);
+        
+        // Test 3: Sections written back to air are released
+        ChunkSection cleared;
+        cleared.set(1, 2, 3, 5);
+        cleared.set(4, 5, 6, 7);
+        cleared.set(1, 2, 3, 0);
+        cleared.set(4, 5, 6, 0);
+        VoxelRegion emptied;
+        emptied.markColumnLoaded(40, 40);
+        size_t bare = emptied.memoryUsage();
+        emptied.setBlock(40, 80, 40, 1);
+        emptied.setBlock(40, 80, 40, 0);
+        logTest("Sections written back to air are released",
+                cleared.isAir() && cleared.get(4, 5, 6) == 0 && emptied.memoryUsage() == bare);
+        
+        // Test 4: Column decode and heightmap agree with stored data
+        BlockId column[VoxelRegion::WORLD_HEIGHT] = {0};
+        for (int y = 0; y <= 64; y++) {
+            column[y] = y < 60 ? 1 : 3;
+        }
+        column[70] = 18;
+        region.storeColumn(-5, 7, column);
+        BlockId decoded[VoxelRegion::WORLD_HEIGHT];
+        region.decodeColumn(-5, 7, decoded);
+        bool same = true;
+        for (int y = 0; y < VoxelRegion::WORLD_HEIGHT; y++) {
+            same = same && decoded[y] == column[y];
+        }
+        logTest("Column decode matches stored column", same);
+        logTest("Highest block read through storage", region.highestNonAir(-5, 7) == 70);
+        logTest("Column marked loaded", region.isColumnLoaded(-5, 7) && !region.isColumnLoaded(-4, 7));
+    }
+    
+    void testScratchArena() {
+        std::cout << "\n--- Scratch Arena Tests ---" << std::endl;
+        
+        // Test 1: Many small buffers come from a single heap block
+        JobArena arena(4096);
+        for (int i = 0; i < 50; i++) {
+            std::pmr::vector<int> scratch(arena.resource());
+            scratch.reserve(8);
+        }
+        ArenaStats stats = arena.stats();
+        logTest("Arena serves scratch allocations", stats.scratch_allocations == 50);
+        logTest("Arena uses one heap block", stats.heap_allocations == 1);
+        
+        // Test 2: Reset clears counts between jobs
+        arena.reset();
+        logTest("Arena reset between jobs", arena.stats().scratch_allocations == 0);
+    }
+    
+    void testPathfinding() {
+        std::cout << "\n--- Pathfinding Tests ---" << std::endl;
+        
+        // 48x48 flat grid with a wall at x = -4, open only at z = 16
+        WalkGrid grid(-24, -24, 48, 48);
+        for (int z = -24; z < 24; z++) {
+            for (int x = -24; x < 24; x++) {
+                grid.setCell(x, z, 64, !(x == -4 && z != 16));
+            }
+        }
+        HierarchicalPathfinder pathfinder(grid);
+        
+        // Test 1: Path crosses clusters through the only gap
+        std::vector<mcpp::Coordinate> path = pathfinder.findPath(-20, -20, 20, -20);
+        bool through_gap = false;
+        bool contiguous = !path.empty();
+        for (size_t i = 0; i < path.size(); i++) {
+            if (path[i].x == -4 && path[i].z == 16) through_gap = true;
+            if (i > 0 && std::abs(path[i].x - path[i - 1].x) + std::abs(path[i].z - path[i - 1].z) != 1) {
+                contiguous = false;
+            }
+        }
+        logTest("Hierarchical path is contiguous", contiguous);
+        logTest("Hierarchical path uses the only gap", through_gap);
+        
+        // Test 2: Slopes above one block are not walkable
+        grid.setCell(-4, 16, 66, true);
+        HierarchicalPathfinder blocked(grid);
+        logTest("Steep step blocks the path", blocked.findPath(-20, -20, 20, -20).empty());
+    }
+    
+    void testPipelineQueue() {
+        std::cout << "\n--- Pipeline Queue Tests ---" << std::endl;
+        
+        // Test 1: Items pass between threads in order through a small queue
+        BoundedQueue<int> queue(2);
+        std::vector<int> received;
+        std::thread consumer([&]() {
+            int item;
+            while (queue.pop(item)) received.push_back(item);
+        });
+        for (int i = 0; i < 100; i++) queue.push(i);
+        queue.close();
+        consumer.join();
+        bool in_order = received.size() == 100;
+        for (size_t i = 0; in_order && i < received.size(); i++) in_order = received[i] == (int)i;
+        logTest("Bounded queue preserves order across threads", in_order);
+        
+        // Test 2: A closed queue rejects new items
+        logTest("Closed queue rejects pushes", !queue.push(1));
+        
+        // Test 3: A search that accepts a plot but comes up short leaves the world untouched
+        FlatWorld shore(1000, 1000);
+        shore.water_from_x = -25;   // room for one plot where a 100-block village needs two
+        VillageGenerator short_search(mcpp::Coordinate(0, 0, 0), 100, 10, 1, true);
+        short_search.setWorldBackend(&shore);
+        PlotSet plots;
+        std::vector<mcpp::Coordinate> waypoints;
+        bool search_failed = false;
+        try {
+            short_search.runPipelined(plots, waypoints);
+        } catch (const std::runtime_error&) {
+            search_failed = true;
+        }
+        logTest("Pipeline writes nothing when the search comes up short", search_failed && shore.writes == 0);
+        
+        // Test 4: A terraforming failure before the perimeter plots are done leaves the wall unbuilt
+        FlatWorld failing(1000, 1000);
+        failing.fail_after = 100;
+        VillageGenerator pipelined(mcpp::Coordinate(0, 0, 0), 100, 10, 1, true);
+        pipelined.setWorldBackend(&failing);
+        bool terraform_failed = false;
+        try {
+            pipelined.runPipelined(plots, waypoints);
+        } catch (const std::runtime_error&) {
+            terraform_failed = true;
+        }
+        bool wall_built = false;
+        for (const auto& edit : failing.edits) {
+            wall_built = wall_built || edit.second == 4;
+        }
+        logTest("Pipeline builds no wall after a terraforming failure", terraform_failed && !wall_built);
+    }
+    
+    // Minimal big-endian NBT writers for building test chunks
+    static void putInt(std::string& out, uint32_t v) {
+        for (int s = 24; s >= 0; s -= 8) out += (char)(v >> s);
+    }
+    static void putName(std::string& out, uint8_t type, const std::string& name) {
+        out += (char)type;
+        out += (char)(name.size() >> 8);
+        out += (char)name.size();
+        out += name;
+    }
+    
+    void testRegionFiles() {
+        std::cout << "\n--- Region File Tests ---" << std::endl;
+        
+        // One 1.18-style chunk at (1, -1): a section at Y=4 holding a single
+        // stone block at local (3, 5, 2), and a Y=-4 section outside our range
+        std::string nbt;
+        putName(nbt, 10, "");
+        putName(nbt, 3, "DataVersion");
+        putInt(nbt, 3465);
+        putName(nbt, 9, "sections");
+        nbt += (char)10;
+        putInt(nbt, 2);
+        for (int y : {4, -4}) {
+            putName(nbt, 1, "Y");
+            nbt += (char)y;
+            putName(nbt, 10, "block_states");
+            putName(nbt, 9, "palette");
+            nbt += (char)10;
+            std::vector<std::string> names = y == 4 ? std::vector<std::string>{"minecraft:air", "minecraft:stone"}
+                                                    : std::vector<std::string>{"minecraft:stone"};
+            putInt(nbt, names.size());
+            for (const std::string& name : names) {
+                putName(nbt, 8, "Name");
+                nbt += (char)(name.size() >> 8);
+                nbt += (char)name.size();
+                nbt += name;
+                nbt += (char)0;
+            }
+            if (y == 4) {
+                putName(nbt, 12, "data");
+                putInt(nbt, 256);
+                int index = (5 << 8) | (2 << 4) | 3;
+                for (int i = 0; i < 256; i++) {
+                    uint64_t v = i == index / 16 ? (uint64_t)1 << ((index % 16) * 4) : 0;
+                    putInt(nbt, (uint32_t)(v >> 32));
+                    putInt(nbt, (uint32_t)v);
+                }
+            }
+            nbt += (char)0;   // end block_states
+            nbt += (char)0;   // end section
+        }
+        nbt += (char)0;       // end root
+        
+        uLongf packed_size = compressBound(nbt.size());
+        std::vector<uint8_t> packed(packed_size);
+        compress(packed.data(), &packed_size, (const Bytef*)nbt.data(), nbt.size());
+        
+        std::string region(8192, '\0');
+        int slot = 4 * (1 + 31 * 32);
+        region[slot + 2] = 2;
+        region[slot + 3] = (char)((packed_size + 5 + 4095) / 4096);
+        putInt(region, packed_size + 1);
+        region += (char)2;
+        region.append((const char*)packed.data(), packed_size);
+        region.resize((region.size() + 4095) / 4096 * 4096, '\0');
+        
+        char dir[] = "/tmp/anvil_testXXXXXX";
+        bool made = mkdtemp(dir) != nullptr;
+        std::string region_dir = std::string(dir) + "/region";
+        made = made && std::system(("mkdir -p " + region_dir).c_str()) == 0;
+        std::ofstream(region_dir + "/r.0.-1.mca", std::ios::binary) << region;
+        
+        // Test 1: Palette sections decode into the voxel store
+        VoxelRegion terrain;
+        bool loaded = false;
+        try {
+            AnvilWorld world(dir);
+            loaded = world.loadChunk(1, -1, terrain) && !world.loadChunk(0, -1, terrain);
+        } catch (const std::exception& e) {
+            std::cout << "  " << e.what() << std::endl;
+        }
+        logTest("Region chunk decoded", made && loaded);
+        logTest("Palette block read from region file",
+                terrain.getBlock(19, 69, -14) == 1 && terrain.getBlock(20, 69, -14) == 0);
+        logTest("Heights ignore sections below y=0",
+                terrain.highestNonAir(19, -14) == 69 && terrain.highestNonAir(20, -14) == -1);
+        logTest("Missing chunks load as air", terrain.isColumnLoaded(5, -5) && terrain.highestNonAir(5, -5) == -1);
+        
+        // Test 2: Block names map to the legacy IDs the rules use
+        logTest("Block names map to legacy IDs",
+                AnvilWorld::legacyId("minecraft:water") == 9 && AnvilWorld::legacyId("minecraft:birch_log") == 17 &&
+                AnvilWorld::legacyId("minecraft:acacia_leaves") == 161 && AnvilWorld::legacyId("minecraft:air") == 0);
+        
+        std::system(("rm -rf " + std::string(dir)).c_str());
+    }
 };
 
 int main() {